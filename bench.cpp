@@ -0,0 +1,1292 @@
+#include "mnk.h"
+#include "bloom.h"
+#include "search.h"
+#include "perft.h"
+#include "book.h"
+#include "engine.h"
+#include "mcts.h"
+#include "tablebase.h"
+#include "td.h"
+#include "menace.h"
+#include "mlp.h"
+#include "inference.h"
+#include "zero.h"
+#include "tune.h"
+#include "replay.h"
+#include "featurize.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// BENCHMARKS
+//
+// Usage:
+//   ./tictactoe_bench            run every benchmark
+//   ./tictactoe_bench zobrist    run only the benchmarks whose name contains
+//                                "zobrist"
+//
+// Build in Release mode (the default in CMakeLists.txt) before trusting any
+// of these numbers.
+// ============================================================================
+
+// Helper: wall-clock seconds taken by f()
+template <typename F>
+double secondsFor(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ============================================================================
+// Zobrist hashing
+// ============================================================================
+
+// Helper: exact identity of a position (boards up to 32 cells)
+std::uint64_t exactCode(const MnkState& s) {
+    return s.x | (s.o << 32);
+}
+
+void benchZobristThroughput() {
+    const MnkRules rules = makeRules(7, 7, 5);
+    std::mt19937_64 rng(2025);
+    const int games = 200000;
+    std::uint64_t sink = 0;
+    long long moves = 0;
+
+    // Incremental: mnkPlay carries the key with one XOR per move
+    double incremental = secondsFor([&]() {
+        for (int g = 0; g < games; ++g) {
+            MnkState s = mnkEmpty();
+            while (!mnkIsGameOver(rules, s)) {
+                const Bitboard empty = emptyCells(rules, s);
+                int skip = static_cast<int>(rng() % __builtin_popcountll(empty));
+                Bitboard b = empty;
+                for (; skip > 0; --skip) b &= b - 1;
+                s = mnkPlay(rules, s, __builtin_ctzll(b));
+                sink += s.key;
+                ++moves;
+            }
+        }
+    });
+
+    // Baseline: the same games, recomputing the key from the board every move
+    rng.seed(2025);
+    double recomputed = secondsFor([&]() {
+        for (int g = 0; g < games; ++g) {
+            MnkState s = mnkEmpty();
+            while (!mnkIsGameOver(rules, s)) {
+                const Bitboard empty = emptyCells(rules, s);
+                int skip = static_cast<int>(rng() % __builtin_popcountll(empty));
+                Bitboard b = empty;
+                for (; skip > 0; --skip) b &= b - 1;
+                s = mnkPlay(rules, s, __builtin_ctzll(b));
+                sink -= computeKey(s.x, s.o);
+            }
+        }
+    });
+
+    std::cout << "  7x7 k=5 random playouts, " << moves << " moves\n";
+    std::cout << "    incremental key: " << std::setprecision(1)
+              << incremental * 1e9 / moves << " ns/move\n";
+    std::cout << "    recomputed key:  " << recomputed * 1e9 / moves << " ns/move\n";
+    std::cout << "    (checksum " << std::hex << sink << std::dec << ", 0 = keys agree)\n";
+}
+
+void benchZobristCollisions() {
+    // Enumerate every reachable 4x4 k=4 position, deduplicated EXACTLY on the
+    // bitboards, then see how many distinct keys (full and truncated) we get.
+    const MnkRules rules = makeRules(4, 4, 4);
+    std::vector<MnkState> layer{mnkEmpty()};
+    std::vector<std::uint64_t> keys;
+    std::size_t mismatches = 0;
+
+    double seconds = secondsFor([&]() {
+        while (!layer.empty()) {
+            for (const MnkState& s : layer) {
+                keys.push_back(s.key);
+                mismatches += s.key != computeKey(s.x, s.o);
+            }
+            std::vector<MnkState> children;
+            for (const MnkState& s : layer) {
+                for (int cell : mnkValidMoves(rules, s)) children.push_back(mnkPlay(rules, s, cell));
+            }
+            std::sort(children.begin(), children.end(),
+                [](const MnkState& a, const MnkState& b) { return exactCode(a) < exactCode(b); });
+            children.erase(std::unique(children.begin(), children.end(),
+                [](const MnkState& a, const MnkState& b) { return exactCode(a) == exactCode(b); }),
+                children.end());
+            layer = std::move(children);
+        }
+    });
+
+    const double n = static_cast<double>(keys.size());
+    std::cout << "  4x4 k=4: " << keys.size() << " distinct positions enumerated in "
+              << std::setprecision(2) << seconds << " s, "
+              << mismatches << " incremental/recomputed key mismatches\n";
+    for (int bits : {64, 40, 32, 24}) {
+        std::vector<std::uint64_t> truncated(keys.size());
+        std::transform(keys.begin(), keys.end(), truncated.begin(),
+            [&](std::uint64_t k) { return bits == 64 ? k : k >> (64 - bits); });
+        std::sort(truncated.begin(), truncated.end());
+        const std::size_t distinct = static_cast<std::size_t>(
+            std::unique(truncated.begin(), truncated.end()) - truncated.begin());
+        // Birthday bound: expected number of positions lost to collisions
+        const double space = std::ldexp(1.0, bits);
+        const double expected = n - space * -std::expm1(-n / space);
+        std::cout << "    " << std::setw(2) << bits << "-bit keys: "
+                  << keys.size() - distinct << " collisions (expected ~"
+                  << std::setprecision(1) << expected << ")\n";
+    }
+    // Zobrist keys are combined with XOR, so they behave like vectors over
+    // GF(2): with 32 keys of 32 or more bits they can be fully independent and
+    // collide far less often than a random hash would. The "expected" column
+    // is the random-hash birthday bound.
+    std::cout << "    (expected = birthday bound for a random hash of that width)\n";
+}
+
+// ============================================================================
+// Perft (move generation)
+// ============================================================================
+
+void benchPerft() {
+    // splitPly 0 = no symmetry grouping: every node is a real mnkPlay call,
+    // so nodes/s measures move generation and nothing else
+    for (const auto& [rules, depth] : {std::pair{makeRules(3, 3, 3), 9}, std::pair{makeRules(4, 4, 4), 7},
+                                       std::pair{makeRules(5, 5, 4), 5}, std::pair{makeRules(6, 6, 4), 5},
+                                       std::pair{makeRules(7, 7, 5), 4}, std::pair{makeRules(8, 8, 5), 4}}) {
+        for (int splitPly : {0, 3}) {
+            PerftReport report;
+            double seconds = secondsFor([&]() { report = perft(rules, mnkEmpty(), depth, 1, splitPly); });
+            std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k << " depth " << depth
+                      << (splitPly == 0 ? ", ungrouped: " : ", grouped:   ") << std::setw(11)
+                      << report.plies.back().nodes << " leaves, " << std::setw(10) << report.visited
+                      << " walked in " << std::setprecision(3) << seconds << " s ("
+                      << std::setprecision(1) << report.visited / seconds / 1e6 << " M nodes/s)\n";
+        }
+    }
+}
+
+// ============================================================================
+// Lazy SMP
+// ============================================================================
+
+void benchLazySmp() {
+    // Solve 4x4 k=4 (a draw) and 5x5 k=4 to a fixed depth with 1, 2 and 4
+    // threads sharing one table
+    for (const auto& [rules, depth] : {std::pair{makeRules(4, 4, 4), 16}, std::pair{makeRules(5, 5, 4), 9}}) {
+        for (int threads : {1, 2, 4}) {
+            TranspositionTable table = makeTable(64);
+            SearchResult result;
+            double seconds = secondsFor([&]() {
+                result = searchPosition(rules, mnkEmpty(), table, SearchLimits{depth, threads, 0.0});
+            });
+            std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k
+                      << " depth " << depth << ", " << threads << " thread(s): move " << result.move
+                      << " score " << result.score << ", " << result.nodes << " nodes in "
+                      << std::setprecision(2) << seconds << " s\n";
+        }
+    }
+    std::cout << "    (" << std::thread::hardware_concurrency() << " hardware threads available)\n";
+}
+
+// ============================================================================
+// Young Brothers Wait
+// ============================================================================
+
+void benchYbwc() {
+    // Same positions as lazy-smp, but the threads split one tree. Extra
+    // nodes over the 1-thread count are the price of searching siblings
+    // before the eldest brother's bound has tightened the window.
+    for (const auto& [rules, depth] : {std::pair{makeRules(4, 4, 4), 16}, std::pair{makeRules(5, 5, 4), 9}}) {
+        for (int threads : {1, 2, 4}) {
+            for (int splitDepth : {4, 6}) {
+                TranspositionTable table = makeTable(64);
+                SearchLimits limits{depth, threads, 0.0};
+                limits.parallel = ParallelMode::Ybwc;
+                limits.splitDepth = splitDepth;
+                SearchResult result;
+                double seconds = secondsFor([&]() { result = searchPosition(rules, mnkEmpty(), table, limits); });
+                std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k
+                          << " depth " << depth << ", " << threads << " thread(s), split depth "
+                          << splitDepth << ": move " << result.move << " score " << result.score << ", "
+                          << result.nodes << " nodes in " << std::setprecision(2) << seconds << " s\n";
+            }
+        }
+    }
+    std::cout << "    (" << std::thread::hardware_concurrency() << " hardware threads available)\n";
+}
+
+// ============================================================================
+// Move ordering
+// ============================================================================
+
+void benchMoveOrdering() {
+    struct Case { int rows, cols, k, depth; };
+    for (const Case& c : {Case{4, 4, 3, 16}, Case{4, 4, 4, 16}, Case{5, 5, 4, 10}, Case{6, 6, 4, 8}, Case{7, 7, 5, 7}}) {
+        const MnkRules rules = makeRules(c.rows, c.cols, c.k);
+        std::cout << "  " << c.rows << "x" << c.cols << " k=" << c.k << " depth " << c.depth << "\n";
+        for (const auto& [killers, history] : {std::pair{false, false}, std::pair{true, false},
+                                               std::pair{false, true}, std::pair{true, true}}) {
+            TranspositionTable table = makeTable(64);
+            SearchLimits limits{c.depth, 1, 0.0};
+            limits.killerMoves = killers;
+            limits.history = history;
+            SearchResult result;
+            double seconds = secondsFor([&]() { result = searchPosition(rules, mnkEmpty(), table, limits); });
+            std::cout << "    " << (killers ? "killers" : "       ") << (history ? " + history" : "          ")
+                      << ": " << std::setw(10) << result.nodes << " nodes, " << std::setprecision(2)
+                      << seconds << " s (score " << result.score << ")\n";
+        }
+    }
+}
+
+// ============================================================================
+// Root drivers
+// ============================================================================
+
+void benchRootDrivers() {
+    struct Case { int rows, cols, k, depth; };
+    struct Driver { const char* name; RootDriver driver; };
+    for (const Case& c : {Case{4, 4, 3, 16}, Case{4, 4, 4, 16}, Case{5, 5, 4, 10}, Case{6, 6, 4, 8}, Case{7, 7, 5, 7}}) {
+        const MnkRules rules = makeRules(c.rows, c.cols, c.k);
+        std::cout << "  " << c.rows << "x" << c.cols << " k=" << c.k << " depth " << c.depth << "\n";
+        std::uint64_t fullNodes = 0;
+        for (const Driver& d : {Driver{"full window", RootDriver::FullWindow},
+                                Driver{"aspiration ", RootDriver::Aspiration},
+                                Driver{"MTD(f)     ", RootDriver::Mtdf}}) {
+            TranspositionTable table = makeTable(64);
+            SearchLimits limits{c.depth, 1, 0.0};
+            limits.driver = d.driver;
+            SearchResult result;
+            double seconds = secondsFor([&]() { result = searchPosition(rules, mnkEmpty(), table, limits); });
+            fullNodes = d.driver == RootDriver::FullWindow ? result.nodes : fullNodes;
+            std::cout << "    " << d.name << ": " << std::setw(10) << result.nodes << " nodes ("
+                      << std::setprecision(2) << static_cast<double>(result.nodes) / static_cast<double>(fullNodes)
+                      << "x), " << std::setw(3) << result.passes << " root passes, " << seconds
+                      << " s (score " << result.score << ")\n";
+        }
+    }
+}
+
+// ============================================================================
+// Leaf evaluation
+// ============================================================================
+
+void benchLeafEval() {
+    // Same search, three ways of scoring the leaves. Full and Incremental
+    // give identical trees, so the node counts match and only speed differs.
+    struct Mode { const char* name; LeafEval eval; };
+    for (const auto& [rules, depth] : {std::pair{makeRules(7, 7, 5), 6}, std::pair{makeRules(8, 8, 5), 5}}) {
+        std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k << " ("
+                  << rules.lines.size() << " lines) depth " << depth << "\n";
+        for (const Mode& m : {Mode{"none       ", LeafEval::None}, Mode{"full       ", LeafEval::Full},
+                              Mode{"incremental", LeafEval::Incremental}}) {
+            TranspositionTable table = makeTable(64);
+            SearchLimits limits{depth, 1, 0.0};
+            limits.leafEval = m.eval;
+            SearchResult result;
+            double seconds = secondsFor([&]() { result = searchPosition(rules, mnkEmpty(), table, limits); });
+            std::cout << "    " << m.name << ": " << std::setw(9) << result.nodes << " nodes in "
+                      << std::setprecision(2) << seconds << " s, " << std::setprecision(1)
+                      << result.nodes / seconds / 1e6 << " M nodes/s (move " << result.move
+                      << ", score " << result.score << ")\n";
+        }
+        // How deep each gets in a fixed time
+        for (const Mode& m : {Mode{"full       ", LeafEval::Full}, Mode{"incremental", LeafEval::Incremental}}) {
+            TranspositionTable table = makeTable(64);
+            SearchLimits limits{maxCells, 1, 1.0};
+            limits.leafEval = m.eval;
+            const SearchResult result = searchPosition(rules, mnkEmpty(), table, limits);
+            std::cout << "    " << m.name << ": depth " << result.depth << " in 1 s\n";
+        }
+    }
+}
+
+// ============================================================================
+// Opening book
+// ============================================================================
+
+void benchOpeningBook() {
+    // Build a small 5x5 book, then compare answering the opening moves from
+    // the book with searching them
+    const MnkRules rules = makeRules(5, 5, 4);
+    BookConfig config;
+    config.plies = 2;
+    config.limits.maxDepth = 7;
+    Book book;
+    double buildSeconds = secondsFor([&]() { book = buildBook(rules, config); });
+    std::cout << "  5x5 k=4 book, 2 plies at depth 7: " << book.size << " entries built in "
+              << std::setprecision(2) << buildSeconds << " s\n";
+
+    // Every position with 0 or 1 pieces, probed over and over
+    std::vector<MnkState> openings{mnkEmpty()};
+    for (int cell = 0; cell < rules.cells; ++cell) openings.push_back(mnkPlay(rules, mnkEmpty(), cell));
+    const MnkStrategy fromBook = bookStrategy(book, mnkRandomStrategy);
+    const int rounds = 2000;
+    int checksum = 0;
+    double bookSeconds = secondsFor([&]() {
+        for (int i = 0; i < rounds; ++i) {
+            for (const MnkState& state : openings) checksum += fromBook(rules, state);
+        }
+    });
+    std::cout << "  book probe:  " << std::setprecision(2)
+              << bookSeconds * 1e6 / (rounds * static_cast<double>(openings.size())) << " us per move\n";
+
+    const MnkStrategy search = searchStrategy(std::make_shared<TranspositionTable>(makeTable(64)),
+                                              SearchLimits{7, 1, 0.0});
+    double searchSeconds = secondsFor([&]() {
+        for (const MnkState& state : openings) checksum += search(rules, state);
+    });
+    std::cout << "  search:      " << std::setprecision(0)
+              << searchSeconds * 1e6 / static_cast<double>(openings.size()) << " us per move (checksum "
+              << checksum << ")\n";
+}
+
+// ============================================================================
+// Pondering
+// ============================================================================
+
+void benchPondering() {
+    // The engine (0.1 s per move) plays X against a "human" who takes 0.5 s
+    // per move and then plays a depth-4 search move. Measured: how long the
+    // engine takes to answer, and how deep its answers were searched.
+    const MnkRules rules = makeRules(7, 7, 5);
+    for (bool ponder : {false, true}) {
+        const std::shared_ptr<Engine> engine = makeEngine(rules, std::make_shared<TranspositionTable>(makeTable(64)),
+                                                          SearchLimits{maxCells, 1, 0.1}, ponder);
+        double thinking = 0.0;
+        int depthSum = 0;
+        const MnkStrategy timedEngine = [&](const MnkRules&, const MnkState& state) {
+            SearchResult result;
+            thinking += secondsFor([&]() { result = engineMove(*engine, state); });
+            depthSum += result.depth;
+            return result.move;
+        };
+        const MnkStrategy human = searchStrategy(std::make_shared<TranspositionTable>(makeTable(16)),
+                                                 SearchLimits{4, 1, 0.0});
+        const MnkStrategy slowHuman = [&](const MnkRules& r, const MnkState& state) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            return human(r, state);
+        };
+        const auto [final, winner] = playMnkGame(rules, timedEngine, slowHuman);
+        engineStopPondering(*engine);
+        const EngineStats& stats = engine->stats;
+        std::cout << "  7x7 k=5, " << (ponder ? "pondering:    " : "no pondering: ") << stats.moves
+                  << " moves, " << std::setprecision(3) << thinking / static_cast<double>(stats.moves)
+                  << " s average answer, average depth " << std::setprecision(1)
+                  << static_cast<double>(depthSum) / static_cast<double>(stats.moves) << ", "
+                  << stats.ponderHits << " ponder hits, " << stats.ponderMisses << " misses ("
+                  << (winner == Cell::X ? "engine won" : winner == Cell::O ? "engine lost" : "draw") << ")\n";
+    }
+}
+
+// ============================================================================
+// MCTS subtree reuse
+// ============================================================================
+
+void benchMctsReuse() {
+    // MCTS with subtree reuse against the same MCTS starting every move from
+    // scratch, alternating colours. Both run 20000 new playouts per move; the
+    // reusing side also inherits the visits already under the new root.
+    const MnkRules rules = makeRules(5, 5, 4);
+    const int games = 10;
+    int wins = 0, draws = 0, losses = 0;
+    std::uint64_t moves = 0, keptVisits = 0, keptNodes = 0;
+    double seconds = 0.0;
+    for (int g = 0; g < games; ++g) {
+        const auto stats = std::make_shared<MctsStats>();
+        const MnkStrategy reuse = mctsStrategy(MctsConfig{20000, 1.4, true, 1000u + g}, stats);
+        const MnkStrategy fresh = mctsStrategy(MctsConfig{20000, 1.4, false, 2000u + g});
+        const MnkStrategy measured = [&](const MnkRules& r, const MnkState& state) {
+            int move = -1;
+            seconds += secondsFor([&]() { move = reuse(r, state); });
+            ++moves;
+            keptVisits += stats->keptVisits;
+            keptNodes += stats->keptNodes;
+            return move;
+        };
+        const Cell me = g % 2 == 0 ? Cell::X : Cell::O;
+        const Cell winner = (me == Cell::X ? playMnkGame(rules, measured, fresh) : playMnkGame(rules, fresh, measured)).second;
+        wins += winner == me;
+        draws += winner == Cell::Empty;
+        losses += winner != me && winner != Cell::Empty;
+    }
+    std::cout << "  5x5 k=4, 20000 playouts per move: " << moves << " moves, on average "
+              << keptVisits / moves << " root visits (" << std::setprecision(0)
+              << 100.0 * static_cast<double>(keptVisits) / static_cast<double>(moves * 20000)
+              << "% of a move's playouts) and " << keptNodes / moves << " nodes carried over\n"
+              << "  " << std::setprecision(1) << seconds * 1e3 / static_cast<double>(moves)
+              << " ms per move including compaction; reuse vs fresh: " << wins << " wins, " << draws
+              << " draws, " << losses << " losses\n";
+}
+
+// ============================================================================
+// RAVE
+// ============================================================================
+
+void benchMctsRave() {
+    // Move accuracy against a solved 4x4 board: a move is right when it keeps
+    // the best outcome the tablebase says the position has. The test
+    // positions are random openings in which some moves are wrong.
+    const MnkRules rules = makeRules(4, 4, 3);
+    const Tablebase tablebase = solveTablebase(rules, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    const auto outcomeAfter = [&](const MnkState& state, int cell) {
+        const MnkState child = mnkPlay(rules, state, cell);
+        if (child.winner != Cell::Empty) return Outcome::Win;
+        const Outcome reply = tablebaseProbe(tablebase, child).outcome;
+        return reply == Outcome::Win ? Outcome::Loss : reply == Outcome::Loss ? Outcome::Win : Outcome::Draw;
+    };
+
+    std::vector<MnkState> positions;
+    std::vector<Bitboard> rightMoves;
+    std::mt19937_64 rng(7);
+    while (positions.size() < 100) {
+        MnkState state = mnkEmpty();
+        for (int ply = static_cast<int>(rng() % 6); ply > 0 && !mnkIsGameOver(rules, state); --ply) {
+            const Bitboard empty = emptyCells(rules, state);
+            Bitboard pick = empty;
+            for (int skip = static_cast<int>(rng() % static_cast<std::uint64_t>(__builtin_popcountll(empty))); skip > 0; --skip) {
+                pick &= pick - 1;
+            }
+            state = mnkPlay(rules, state, __builtin_ctzll(pick));
+        }
+        if (mnkIsGameOver(rules, state)) continue;
+        const Outcome best = tablebaseProbe(tablebase, state).outcome;
+        Bitboard right = 0;
+        for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+            if (outcomeAfter(state, __builtin_ctzll(b)) == best) right |= b & -b;
+        }
+        if (right == emptyCells(rules, state)) continue;   // nothing to get wrong
+        positions.push_back(state);
+        rightMoves.push_back(right);
+    }
+
+    const int budgets[] = {25, 50, 100, 200, 400, 800, 1600, 3200};
+    for (bool rave : {false, true}) {
+        std::cout << "  4x4 k=3, " << (rave ? "RAVE:" : "UCT: ");
+        int reached = 0;
+        for (int playouts : budgets) {
+            MctsConfig config;
+            config.playouts = playouts;
+            config.rave = rave;
+            int right = 0;
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                MctsTree tree = makeMctsTree(positions[i], 100 + i);
+                mctsSearch(rules, tree, config);
+                right += (rightMoves[i] >> mctsBestMove(tree)) & 1;
+            }
+            if (reached == 0 && right >= 90) reached = playouts;
+            std::cout << " " << playouts << ":" << right << "%";
+        }
+        std::cout << "  -> 90% at " << (reached > 0 ? std::to_string(reached) + " playouts" : std::string("never")) << "\n";
+    }
+}
+
+// ============================================================================
+// Tabular TD learning
+// ============================================================================
+
+// Helper: every reachable unfinished position in which some move throws away
+// the tablebase outcome, with the set of moves that keep it
+std::vector<std::pair<MnkState, Bitboard>> testablePositions(const Tablebase& tablebase) {
+    const MnkRules& rules = tablebase.rules;
+    std::vector<std::pair<MnkState, Bitboard>> positions;
+    std::unordered_set<std::uint64_t> seen;
+    std::vector<MnkState> stack{mnkEmpty()};
+    while (!stack.empty()) {
+        const MnkState state = stack.back();
+        stack.pop_back();
+        if (mnkIsGameOver(rules, state) || !seen.insert(computeKey(state.x, state.o)).second) continue;
+        const Outcome best = tablebaseProbe(tablebase, state).outcome;
+        Bitboard right = 0;
+        for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+            const MnkState child = mnkPlay(rules, state, __builtin_ctzll(b));
+            const Outcome reply = child.winner != Cell::Empty ? Outcome::Loss : tablebaseProbe(tablebase, child).outcome;
+            const Outcome mine = reply == Outcome::Win ? Outcome::Loss : reply == Outcome::Loss ? Outcome::Win : Outcome::Draw;
+            if (mine == best) right |= b & -b;
+            stack.push_back(child);
+        }
+        if (right != emptyCells(rules, state)) positions.emplace_back(state, right);
+    }
+    return positions;
+}
+
+// Helper: share of the test positions in which 'strategy' keeps the outcome
+double rightMoveShare(const MnkStrategy& strategy, const MnkRules& rules,
+                      const std::vector<std::pair<MnkState, Bitboard>>& positions) {
+    std::size_t right = 0;
+    for (const auto& [state, moves] : positions) right += (moves >> strategy(rules, state)) & 1;
+    return static_cast<double>(right) / static_cast<double>(positions.size());
+}
+
+void benchTdTraining() {
+    // Self-play Q-learning from a blank table, measured against the solved
+    // board after every doubling of the number of games
+    for (const MnkRules& rules : {makeRules(3, 3, 3), makeRules(3, 4, 3)}) {
+        const auto positions = testablePositions(solveTablebase(rules, 1));
+        const auto table = std::make_shared<ValueTable>(makeValueTable(rules));
+        TdStats total;
+        double seconds = 0.0;
+        std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k << " ("
+                  << positions.size() << " test positions, " << table->values.size() << " table entries)\n";
+        for (int games = 1000, trained = 0; games <= 256000; games *= 2) {
+            TdConfig config;
+            config.games = games - trained;
+            config.seed = static_cast<std::uint64_t>(games);
+            seconds += secondsFor([&]() {
+                const TdStats stats = tdTrain(*table, config);
+                total.games += stats.games;
+                total.updates += stats.updates;
+            });
+            trained = games;
+            const double right = rightMoveShare(valueTableStrategy(table), rules, positions);
+            std::cout << "    " << std::setw(6) << games << " games: " << std::setprecision(1)
+                      << std::setw(5) << 100.0 * right << "% right moves, " << std::setprecision(2) << std::setw(5) << seconds << " s, "
+                      << std::setprecision(0) << static_cast<double>(total.updates) / seconds << " updates/s\n";
+        }
+    }
+}
+
+void benchTdHogwild() {
+    // The same learning, with 1..8 threads writing into one lock-free table:
+    // train in rounds until 99% of the test positions get a right move
+    const MnkRules rules = makeRules(3, 4, 3);
+    const auto positions = testablePositions(solveTablebase(rules, 1));
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "  3x4 k=3, " << cores << " hardware threads\n";
+    for (int threads : {1, 2, 4, 8}) {
+        const auto table = std::make_shared<ValueTable>(makeValueTable(rules));
+        TdConfig config;
+        config.games = 16000;
+        config.threads = threads;
+        TdStats total;
+        double seconds = 0.0;
+        double right = 0.0;
+        for (int round = 1; right < 0.99 && total.games < 2000000; ++round) {
+            config.seed = static_cast<std::uint64_t>(round);
+            seconds += secondsFor([&]() {
+                const TdStats stats = tdTrain(*table, config);
+                total.games += stats.games;
+                total.updates += stats.updates;
+            });
+            right = rightMoveShare(valueTableStrategy(table), rules, positions);
+        }
+        std::cout << "    " << threads << " threads: " << std::setprecision(1) << 100.0 * right << "% after "
+                  << total.games << " games, " << std::setprecision(2) << seconds << " s ("
+                  << std::setprecision(0) << static_cast<double>(total.updates) / seconds << " updates/s)\n";
+    }
+}
+
+// ============================================================================
+// MENACE
+// ============================================================================
+
+void benchMenace() {
+    // MENACE learning 3x3 as X, first against a random player and then
+    // against perfect play, with its results per block of games
+    const MnkRules rules = classicRules();
+    const MnkStrategy perfect = tablebaseStrategy(solveTablebase(rules, 1));
+    const auto random = [](const MnkRules& r, const MnkState& state) { return mnkRandomStrategy(r, state); };
+    srand(1);
+    for (const auto& [name, opponent] : {std::pair<const char*, MnkStrategy>{"random ", random},
+                                         std::pair<const char*, MnkStrategy>{"perfect", perfect}}) {
+        Menace menace = makeMenace(rules);
+        std::cout << "  vs " << name << " (" << menace.totals.size() << " boxes), wins/draws/losses per 500 games:";
+        for (int block = 0; block < 6; ++block) {
+            int results[3] = {};
+            for (int g = 0; g < 500; ++g) {
+                const Cell winner = menaceTrainGame(menace, Cell::X, opponent);
+                ++results[winner == Cell::X ? 0 : winner == Cell::Empty ? 1 : 2];
+            }
+            std::cout << " " << results[0] << "/" << results[1] << "/" << results[2];
+        }
+        std::cout << "\n";
+    }
+
+    // Weighted sampling throughput: draws from every box in turn
+    Menace menace = makeMenace(rules);
+    std::vector<MnkState> states;
+    for (std::uint64_t rank = 0; rank < menace.boxOf.size(); ++rank) {
+        if (menace.boxOf[rank] < 0) continue;
+        const auto [x, o] = positionUnrank(rules.cells, rank);
+        states.push_back(stateFromBitboards(rules, x, o));
+    }
+    const int draws = 10000000;
+    std::uint64_t sum = 0;
+    const double seconds = secondsFor([&]() {
+        for (int i = 0; i < draws; ++i) sum += static_cast<std::uint64_t>(menaceDraw(menace, states[static_cast<std::size_t>(i) % states.size()]).cell);
+    });
+    std::cout << "  " << std::setprecision(1) << draws / seconds / 1e6 << "M bead draws/s (checksum "
+              << sum << ")\n";
+}
+
+// ============================================================================
+// MLP inference
+// ============================================================================
+
+// Helper: 'count' positions reached by random moves, none of them finished
+std::vector<MnkState> randomPositions(const MnkRules& rules, std::size_t count, std::uint64_t seed) {
+    std::vector<MnkState> positions;
+    std::uint64_t counter = seed;
+    while (positions.size() < count) {
+        MnkState state = mnkEmpty();
+        for (int ply = static_cast<int>(splitMix64(counter++) % static_cast<std::uint64_t>(rules.cells)); ply > 0; --ply) {
+            const std::vector<int> moves = mnkValidMoves(rules, state);
+            const MnkState next = mnkPlay(rules, state, moves[splitMix64(counter++) % moves.size()]);
+            if (mnkIsGameOver(rules, next)) break;
+            state = next;
+        }
+        positions.push_back(state);
+    }
+    return positions;
+}
+
+void benchMlpInference() {
+    std::cout << "  AVX2/FMA " << (mlpAvx2Available() ? "available" : "NOT available (both rows run scalar)") << "\n";
+    for (const auto& [rules, hidden] : {std::pair{makeRules(3, 3, 3), 32}, std::pair{makeRules(5, 5, 4), 64},
+                                        std::pair{makeRules(7, 7, 5), 128}, std::pair{makeRules(8, 8, 5), 256}}) {
+        const Mlp mlp = makeMlp(rules, hidden, 1);
+        const std::vector<MnkState> positions = randomPositions(rules, 4096, 2);
+        float difference = 0.0f;
+        for (const MnkState& state : positions) {
+            const MlpOutput a = mlpForward(mlp, state, MlpKernel::Scalar);
+            const MlpOutput b = mlpForward(mlp, state, MlpKernel::Avx2);
+            difference = std::max(difference, std::fabs(a.value - b.value));
+            for (int c = 0; c < rules.cells; ++c) difference = std::max(difference, std::fabs(a.logits[c] - b.logits[c]));
+        }
+        std::cout << "  " << rules.rows << "x" << rules.cols << ", " << hidden << " hidden:";
+        for (MlpKernel kernel : {MlpKernel::Scalar, MlpKernel::Avx2}) {
+            const int rounds = 100;
+            float sum = 0.0f;
+            const double seconds = secondsFor([&]() {
+                for (int r = 0; r < rounds; ++r) {
+                    for (const MnkState& state : positions) sum += mlpForward(mlp, state, kernel).value;
+                }
+            });
+            std::cout << (kernel == MlpKernel::Scalar ? " scalar " : ", AVX2 ") << std::setprecision(0)
+                      << rounds * positions.size() / seconds / 1e3 << "k/s (checksum " << std::setprecision(1) << sum << ")";
+        }
+        std::cout << ", largest difference " << std::scientific << std::setprecision(1) << difference
+                  << std::fixed << "\n";
+    }
+}
+
+// ============================================================================
+// Batched inference
+// ============================================================================
+
+void benchBatchedInference() {
+    // The kernels alone: one position at a time against tiles of the batch
+    for (const auto& [rules, hidden] : {std::pair{makeRules(7, 7, 5), 128}, std::pair{makeRules(8, 8, 5), 256}}) {
+        const Mlp mlp = makeMlp(rules, hidden, 5);
+        const std::vector<MnkState> positions = randomPositions(rules, 4096, 6);
+        std::vector<MlpOutput> outputs(positions.size());
+        const int rounds = 50;
+        const double single = secondsFor([&]() {
+            for (int r = 0; r < rounds; ++r) {
+                for (std::size_t i = 0; i < positions.size(); ++i) outputs[i] = mlpForward(mlp, positions[i]);
+            }
+        });
+        float difference = 0.0f;
+        for (std::size_t i = 0; i < positions.size(); i += 256) {
+            std::vector<MlpOutput> batch(256);
+            mlpForwardBatch(mlp, &positions[i], 256, batch.data());
+            for (std::size_t j = 0; j < 256; ++j) difference = std::max(difference, std::fabs(batch[j].value - outputs[i + j].value));
+        }
+        const double batched = secondsFor([&]() {
+            for (int r = 0; r < rounds; ++r) {
+                mlpForwardBatch(mlp, positions.data(), static_cast<int>(positions.size()), outputs.data());
+            }
+        });
+        const double count = static_cast<double>(rounds) * static_cast<double>(positions.size());
+        std::cout << "  " << rules.rows << "x" << rules.cols << ", " << hidden << " hidden: one at a time "
+                  << std::setprecision(0) << count / single / 1e3 << "k/s, batched " << count / batched / 1e3
+                  << "k/s (values differ by at most " << std::scientific << std::setprecision(1) << difference
+                  << std::fixed << ")\n";
+    }
+
+    // The server: 64 client threads each wanting one evaluation at a time
+    const MnkRules rules = makeRules(7, 7, 5);
+    const auto mlp = std::make_shared<const Mlp>(makeMlp(rules, 128, 5));
+    const std::vector<MnkState> positions = randomPositions(rules, 4096, 7);
+    const int clients = 64;
+    const int perClient = 2000;
+    for (int batchSize : {1, 16, 64, 256}) {
+        BatchConfig config;
+        config.batchSize = batchSize;
+        config.maxWait = std::chrono::microseconds(500);
+        const std::shared_ptr<InferenceServer> server = startInferenceServer(mlp, config);
+        std::atomic<std::uint64_t> checksum{0};
+        const double seconds = secondsFor([&]() {
+            std::vector<std::thread> threads;
+            for (int c = 0; c < clients; ++c) {
+                threads.emplace_back([&, c]() {
+                    std::uint64_t moves = 0;
+                    for (int i = 0; i < perClient; ++i) {
+                        const MnkState& state = positions[static_cast<std::size_t>(c * perClient + i) % positions.size()];
+                        moves += static_cast<std::uint64_t>(mlpBestMove(rules, state, inferenceSubmit(*server, state).get()));
+                    }
+                    checksum += moves;
+                });
+            }
+            std::for_each(threads.begin(), threads.end(), [](std::thread& t) { t.join(); });
+        });
+        stopInferenceServer(*server);
+        const InferenceStats stats = inferenceStats(*server);
+        std::cout << "  server, batch size " << std::setw(3) << batchSize << ": " << std::setprecision(0)
+                  << static_cast<double>(stats.requests) / seconds / 1e3 << "k requests/s, average batch "
+                  << std::setprecision(1) << static_cast<double>(stats.requests) / static_cast<double>(stats.batches)
+                  << ", " << stats.fullBatches << " of " << stats.batches << " batches full (checksum "
+                  << checksum.load() << ")\n";
+    }
+}
+
+// ============================================================================
+// NNUE accumulator
+// ============================================================================
+
+void benchNnue() {
+    const MnkRules rules = makeRules(7, 7, 5);
+    const Mlp mlp = makeMlp(rules, 128, 3);
+    const auto net = std::make_shared<const QuantNet>(quantizeMlp(mlp));
+    const std::vector<MnkState> positions = randomPositions(rules, 4096, 4);
+
+    // Quantization error, and the cost of one leaf evaluation three ways
+    NnueAccumulator accumulator;
+    float error = 0.0f;
+    for (const MnkState& state : positions) {
+        nnueRefresh(*net, accumulator, state);
+        error = std::max(error, std::fabs(nnueValue(*net, accumulator, state.toMove) - mlpForward(mlp, state).value));
+    }
+    const int rounds = 200;
+    const double evaluations = static_cast<double>(rounds) * static_cast<double>(positions.size());
+    float sum = 0.0f;
+    const double full = secondsFor([&]() {
+        for (int r = 0; r < rounds; ++r) {
+            for (const MnkState& state : positions) sum += mlpForward(mlp, state).value;
+        }
+    });
+    const double refresh = secondsFor([&]() {
+        for (int r = 0; r < rounds; ++r) {
+            for (const MnkState& state : positions) {
+                nnueRefresh(*net, accumulator, state);
+                sum += nnueValue(*net, accumulator, state.toMove);
+            }
+        }
+    });
+    // A leaf as the search sees it: make the last move, evaluate, undo
+    const double incremental = secondsFor([&]() {
+        for (int r = 0; r < rounds; ++r) {
+            for (const MnkState& state : positions) {
+                const int cell = __builtin_ctzll(emptyCells(rules, state));
+                nnueAdd(*net, accumulator, state.toMove, cell);
+                sum += nnueValue(*net, accumulator, nextPlayer(state.toMove));
+                nnueRemove(*net, accumulator, state.toMove, cell);
+            }
+        }
+    });
+    std::cout << "  7x7, 128 hidden: int8 vs float value differ by at most " << std::setprecision(4) << error
+              << "\n  float forward pass " << std::setprecision(0) << full / evaluations * 1e9
+              << " ns, int8 refresh " << refresh / evaluations * 1e9 << " ns, int8 make/evaluate/undo "
+              << incremental / evaluations * 1e9 << " ns (checksum " << std::setprecision(1) << sum << ")\n";
+
+    // In the search, against the line-pattern evaluation it would replace
+    for (const LeafEval eval : {LeafEval::Incremental, LeafEval::Network}) {
+        TranspositionTable table = makeTable(64);
+        SearchLimits limits{6, 1, 0.0};
+        limits.leafEval = eval;
+        limits.network = net;
+        SearchResult result;
+        const double seconds = secondsFor([&]() { result = searchPosition(rules, mnkEmpty(), table, limits); });
+        std::cout << "  depth 6 search, " << (eval == LeafEval::Network ? "network: " : "patterns:") << std::setw(9)
+                  << result.nodes << " nodes, " << std::setprecision(1) << result.nodes / seconds / 1e6
+                  << " M nodes/s\n";
+    }
+}
+
+// ============================================================================
+// AlphaZero-style self-play
+// ============================================================================
+
+// Helper: train on one board and report
+void benchAlphaZeroOn(const MnkRules& rules, bool checkTablebase) {
+    std::vector<std::pair<MnkState, Bitboard>> positions, sampled;
+    if (checkTablebase) positions = testablePositions(solveTablebase(rules, 1));
+    for (std::size_t i = 0; i < positions.size(); i += 100) sampled.push_back(positions[i]);
+    ZeroConfig config;
+    config.generations = 8;
+    config.gamesPerGeneration = 96;
+    std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k << ", " << config.workers
+              << " workers, " << config.simulations << " simulations/move\n";
+    if (checkTablebase) {
+        const Mlp initial = makeMlp(rules, config.hidden, config.seed);
+        std::cout << "    untrained: policy " << std::setprecision(1)
+                  << 100.0 * rightMoveShare(mlpStrategy(std::make_shared<const Mlp>(initial)), rules, positions)
+                  << "% right of " << positions.size() << " test positions\n";
+    }
+    const Mlp mlp = zeroTrain(rules, config, [&](const ZeroGeneration& g) {
+        std::cout << "    generation " << g.generation << ": " << g.xWins << "/" << g.draws << "/" << g.oWins
+                  << " X/draw/O, " << std::setprecision(0) << g.samples / g.selfPlaySeconds << " samples/s, "
+                  << static_cast<double>(g.inference.requests) / g.selfPlaySeconds / 1e3 << "k evals/s, batch "
+                  << std::setprecision(1) << static_cast<double>(g.inference.requests) / static_cast<double>(g.inference.batches)
+                  << ", loss " << std::setprecision(3) << g.loss.policy << " + " << g.loss.value << ", training "
+                  << std::setprecision(2) << g.trainingSeconds << " s\n";
+    });
+    const auto trained = std::make_shared<const Mlp>(mlp);
+    if (checkTablebase) {
+        std::cout << "    trained: policy " << std::setprecision(1)
+                  << 100.0 * rightMoveShare(mlpStrategy(trained), rules, positions) << "% right, search "
+                  << 100.0 * rightMoveShare(zeroStrategy(trained, config.simulations), rules, sampled)
+                  << "% right (of " << sampled.size() << ")\n";
+    }
+
+    // Playing it against a random player
+    srand(1);
+    const auto random = [](const MnkRules& r, const MnkState& state) { return mnkRandomStrategy(r, state); };
+    const MnkStrategy zero = zeroStrategy(trained, config.simulations);
+    int xWins = 0, oLosses = 0;
+    const int games = 100;
+    for (int g = 0; g < games; ++g) {
+        xWins += playMnkGame(rules, zero, random).second == Cell::X;
+        oLosses += playMnkGame(rules, random, zero).second == Cell::X;
+    }
+    std::cout << "    vs random: won " << xWins << "/" << games << " as X, lost " << oLosses << "/" << games << " as O\n";
+}
+
+void benchAlphaZero() {
+    // The whole loop from random weights. On 4x4 k=3 (a first-player win)
+    // accuracy is the share of tablebase test positions where the move keeps
+    // the outcome - for the raw policy head's favourite, and for a search on
+    // every 100th position (it is slower). 5x5 k=4 is too big for the
+    // tablebase, so there it only plays.
+    for (const MnkRules& rules : {makeRules(4, 4, 3), makeRules(5, 5, 4)}) {
+        benchAlphaZeroOn(rules, rules.cells <= maxTablebaseCells);
+    }
+}
+
+// ============================================================================
+// Replay store
+// ============================================================================
+
+void benchReplayStore() {
+    // 2M 5x5 samples with a uniform policy over the empty cells, stored
+    // packed and as one heap-allocated policy per sample
+    struct LooseSample {
+        MnkState state;
+        std::vector<float> policy;
+        float value;
+    };
+    const MnkRules rules = makeRules(5, 5, 4);
+    const std::size_t count = 2000000;
+    const std::vector<MnkState> positions = randomPositions(rules, 4096, 8);
+    const auto policyFor = [&](const MnkState& state) {
+        std::vector<float> policy(static_cast<std::size_t>(rules.cells), 0.0f);
+        const Bitboard empty = emptyCells(rules, state);
+        for (Bitboard b = empty; b != 0; b &= b - 1) policy[static_cast<std::size_t>(__builtin_ctzll(b))] = 1.0f / static_cast<float>(__builtin_popcountll(empty));
+        return policy;
+    };
+
+    const std::unique_ptr<ReplayStore> store = makeReplayStore(rules, count, 1);
+    std::vector<LooseSample> loose;
+    const double packedAppend = secondsFor([&]() {
+        for (std::size_t i = 0; i < count; ++i) {
+            const MnkState& state = positions[i % positions.size()];
+            replayAppend(*store, 0, state, policyFor(state).data(), 1.0f);
+        }
+    });
+    const double looseAppend = secondsFor([&]() {
+        for (std::size_t i = 0; i < count; ++i) {
+            const MnkState& state = positions[i % positions.size()];
+            loose.push_back(LooseSample{state, policyFor(state), 1.0f});
+        }
+    });
+    const std::size_t packedBytes = static_cast<std::size_t>(store->stride) * 8 + sizeof(float);
+    const std::size_t looseBytes = sizeof(LooseSample) + static_cast<std::size_t>(rules.cells) * sizeof(float) + 16;
+    std::cout << "  5x5, " << count / 1000000 << "M samples: packed " << packedBytes << " bytes/sample, "
+              << "loose ~" << looseBytes << " (with allocator overhead); appends " << std::setprecision(1)
+              << count / packedAppend / 1e6 << "M/s packed, " << count / looseAppend / 1e6 << "M/s loose\n";
+
+    // Drawing 256-sample batches at random
+    const int batches = 4000;
+    const int batchSize = 256;
+    TrainingBatch batch;
+    std::uint64_t rng = 1;
+    float checksum = 0.0f;
+    const double looseSample = secondsFor([&]() {
+        for (int b = 0; b < batches; ++b) {
+            batch.states.resize(batchSize);
+            batch.values.resize(batchSize);
+            batch.policies.resize(static_cast<std::size_t>(batchSize * rules.cells));
+            for (int i = 0; i < batchSize; ++i) {
+                const LooseSample& sample = loose[splitMix64(rng++) % loose.size()];
+                batch.states[static_cast<std::size_t>(i)] = sample.state;
+                batch.values[static_cast<std::size_t>(i)] = sample.value;
+                std::copy(sample.policy.begin(), sample.policy.end(), &batch.policies[static_cast<std::size_t>(i * rules.cells)]);
+            }
+            checksum += batch.policies[0];
+        }
+    });
+    std::cout << "  256-sample batches: loose " << std::setprecision(1) << batches * batchSize / looseSample / 1e6 << "M samples/s";
+    for (const ReplaySampling sampling : {ReplaySampling::Uniform, ReplaySampling::Prioritized}) {
+        const double seconds = secondsFor([&]() {
+            for (int b = 0; b < batches; ++b) {
+                replaySample(*store, batchSize, sampling, rng, batch);
+                checksum += batch.policies[0];
+            }
+        });
+        std::cout << ", packed " << (sampling == ReplaySampling::Uniform ? "uniform " : "prioritized ")
+                  << batches * batchSize / seconds / 1e6 << "M samples/s";
+    }
+    std::cout << " (checksum " << checksum << ")\n";
+
+    // Prioritized sampling follows the priorities: give every 10th slot
+    // priority 9, the rest 1, and they should make half of the draws
+    for (std::uint64_t slot = 0; slot < count; ++slot) replaySetPriority(*store, slot, slot % 10 == 0 ? 9.0f : 1.0f);
+    std::vector<std::uint64_t> slots;
+    std::size_t high = 0;
+    for (int b = 0; b < 100; ++b) {
+        replaySample(*store, batchSize, ReplaySampling::Prioritized, rng, batch, &slots);
+        for (std::uint64_t slot : slots) high += slot % 10 == 0;
+    }
+    std::cout << "  prioritized: priority-9 slots (10% of them) drew " << std::setprecision(1)
+              << 100.0 * static_cast<double>(high) / (100.0 * batchSize) << "% of samples (expect 50%)\n";
+
+    // Four writers appending while one reader samples, checking that every
+    // sample it reads is whole: no piece on a cell the policy plays
+    const std::unique_ptr<ReplayStore> shared = makeReplayStore(rules, 4096, 4);
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> appends{0};
+    std::uint64_t drawn = 0, torn = 0;
+    const double seconds = secondsFor([&]() {
+        std::vector<std::thread> writers;
+        for (int w = 0; w < 4; ++w) {
+            writers.emplace_back([&, w]() {
+                std::uint64_t n = 0;
+                for (std::size_t i = static_cast<std::size_t>(w); !done.load(); i += 7, ++n) {
+                    const MnkState& state = positions[i % positions.size()];
+                    replayAppend(*shared, w, state, policyFor(state).data(), 0.0f);
+                }
+                appends += n;
+            });
+        }
+        while (replaySize(*shared) == 0) std::this_thread::yield();
+        std::uint64_t readerRng = 7;
+        for (int b = 0; b < 2000; ++b) {
+            replaySample(*shared, 64, ReplaySampling::Uniform, readerRng, batch);
+            for (std::size_t i = 0; i < batch.states.size(); ++i) {
+                const Bitboard occupied = batch.states[i].x | batch.states[i].o;
+                for (int c = 0; c < rules.cells; ++c) torn += ((occupied >> c) & 1) && batch.policies[i * static_cast<std::size_t>(rules.cells) + static_cast<std::size_t>(c)] > 0.0f;
+                ++drawn;
+            }
+        }
+        done = true;
+        std::for_each(writers.begin(), writers.end(), [](std::thread& t) { t.join(); });
+    });
+    std::cout << "  4 writers + 1 reader: " << std::setprecision(1) << static_cast<double>(appends.load()) / seconds / 1e6
+              << "M appends/s, " << static_cast<double>(drawn) / seconds / 1e6 << "M samples/s read, "
+              << torn << " torn samples\n";
+}
+
+// ============================================================================
+// Feature extraction
+// ============================================================================
+
+void benchFeatureExtraction() {
+    std::cout << "  AVX-512 " << (featureAvx512Available() ? "available" : "NOT available (scalar runs twice)") << "\n";
+    for (const MnkRules& rules : {makeRules(5, 5, 4), makeRules(8, 8, 5)}) {
+        const FeatureTables tables = makeFeatureTables(rules);
+        const std::vector<MnkState> positions = randomPositions(rules, 100000, 3);
+        const int count = static_cast<int>(positions.size());
+        const std::size_t cells = static_cast<std::size_t>(rules.cells);
+        const std::size_t symmetries = rules.symmetries.size();
+        std::vector<float> planes(positions.size() * featurePlanes * cells);
+        std::vector<float> counts(positions.size() * 2 * static_cast<std::size_t>(tables.lineCount));
+        std::vector<MnkState> images(positions.size() * symmetries);
+
+        // The way it is done without the kernels: ask every cell what is on
+        // it, and walk every line cell by cell
+        const auto cellAt = [](const MnkState& state, int cell) {
+            return (state.x >> cell) & 1 ? Cell::X : (state.o >> cell) & 1 ? Cell::O : Cell::Empty;
+        };
+        const double perCell = secondsFor([&]() {
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                const MnkState& state = positions[i];
+                float* out = &planes[i * featurePlanes * cells];
+                std::fill(out + 3 * cells, out + 5 * cells, 0.0f);
+                for (std::size_t c = 0; c < cells; ++c) {
+                    const Cell cell = cellAt(state, static_cast<int>(c));
+                    out[c] = cell == state.toMove;
+                    out[cells + c] = cell != Cell::Empty && cell != state.toMove;
+                    out[2 * cells + c] = cell == Cell::Empty;
+                }
+                for (const Bitboard line : rules.lines) {
+                    int ours = 0, theirs = 0, gap = -1;
+                    for (Bitboard b = line; b != 0; b &= b - 1) {
+                        const Cell cell = cellAt(state, __builtin_ctzll(b));
+                        if (cell == Cell::Empty) gap = __builtin_ctzll(b);
+                        else ++(cell == state.toMove ? ours : theirs);
+                    }
+                    if (gap >= 0 && ours == rules.k - 1 && theirs == 0) out[3 * cells + static_cast<std::size_t>(gap)] = 1.0f;
+                    if (gap >= 0 && theirs == rules.k - 1 && ours == 0) out[4 * cells + static_cast<std::size_t>(gap)] = 1.0f;
+                }
+            }
+        });
+        const std::vector<float> reference = planes;
+        std::cout << "  " << rules.rows << "x" << rules.cols << " k=" << rules.k << ", " << count / 1000
+                  << "k positions, M boards/s: planes per cell " << std::setprecision(1) << count / perCell / 1e6;
+
+        std::vector<float> scalarCounts;
+        std::vector<MnkState> scalarImages;
+        for (const FeatureKernel kernel : {FeatureKernel::Scalar, FeatureKernel::Avx512}) {
+            const double planeSeconds = secondsFor([&]() { extractPlanes(tables, positions.data(), count, planes.data(), kernel); });
+            const double countSeconds = secondsFor([&]() { extractLineCounts(tables, positions.data(), count, counts.data(), kernel); });
+            const double imageSeconds = secondsFor([&]() { symmetryImages(tables, positions.data(), count, images.data(), kernel); });
+            const bool scalar = kernel == FeatureKernel::Scalar;
+            bool same = planes == reference;
+            if (scalar) {
+                scalarCounts = counts;
+                scalarImages = images;
+            } else {
+                same = same && counts == scalarCounts &&
+                       std::equal(images.begin(), images.end(), scalarImages.begin(), [](const MnkState& a, const MnkState& b) {
+                           return a.x == b.x && a.o == b.o && a.key == b.key;
+                       });
+            }
+            std::cout << (scalar ? "; scalar " : "; AVX-512 ") << count / planeSeconds / 1e6 << ", counts "
+                      << count / countSeconds / 1e6 << ", " << symmetries << " images " << count / imageSeconds / 1e6
+                      << (same ? "" : " MISMATCH");
+        }
+        std::cout << "\n";
+
+        // Turning a batch by random symmetries, as training does: through
+        // stateFromBitboards (which rescans the lines) against the kernels
+        std::uint64_t rng = 1;
+        Bitboard checksum = 0;
+        const double rebuilt = secondsFor([&]() {
+            for (const MnkState& state : positions) {
+                const int s = static_cast<int>(splitMix64(rng++) % symmetries);
+                checksum ^= stateFromBitboards(rules, transformBitboard(rules, state.x, s), transformBitboard(rules, state.o, s)).key;
+            }
+        });
+        const double shuffled = secondsFor([&]() {
+            for (const MnkState& state : positions) {
+                checksum ^= featureTransform(tables, state, static_cast<int>(splitMix64(rng++) % symmetries)).key;
+            }
+        });
+        std::cout << "    random symmetry per sample: rebuilt " << count / rebuilt / 1e6 << "M/s, shuffled "
+                  << count / shuffled / 1e6 << "M/s (checksum " << (checksum & 0xFFFF) << ")\n";
+    }
+}
+
+// ============================================================================
+// Genetic tuning
+// ============================================================================
+
+void benchGeneticTuning() {
+    // Evolve the line heuristic on 6x6 k=4 from random weights, against the
+    // hand-picked weights and a more defensive variant of them
+    const MnkRules rules = makeRules(6, 6, 4);
+    const HeuristicWeights hand = defaultHeuristicWeights(rules);
+    HeuristicWeights defensive = hand;
+    for (int c = 0; c < rules.k - 1; ++c) defensive[static_cast<std::size_t>(rules.k + c)] *= 2.0f;
+    const std::vector<MnkStrategy> references{heuristicStrategy(hand), heuristicStrategy(defensive)};
+
+    // Common random numbers: the spread of the fitness DIFFERENCE between two
+    // close candidates, over repeated 16-opening tournaments
+    HeuristicWeights nudged = hand;
+    nudged[1] *= 1.1f;
+    for (bool common : {false, true}) {
+        double sum = 0.0, squares = 0.0;
+        const int repeats = 40;
+        for (int r = 0; r < repeats; ++r) {
+            const auto seed = static_cast<std::uint64_t>(r);
+            const double d = heuristicFitness(rules, nudged, references, 16, 4, seed) -
+                             heuristicFitness(rules, hand, references, 16, 4, common ? seed : seed + 1000);
+            sum += d;
+            squares += d * d;
+        }
+        const double mean = sum / repeats;
+        std::cout << "  " << (common ? "common openings:     " : "independent openings:") << " difference "
+                  << std::setprecision(3) << mean << " +- " << std::sqrt(squares / repeats - mean * mean) << "\n";
+    }
+
+    TuneConfig config;
+    config.population = 48;
+    config.generations = 40;
+    config.openings = 32;
+    config.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "  6x6 k=4, population " << config.population << ", " << config.openings << " openings x "
+              << references.size() << " references x 2 colours, " << config.threads << " threads\n";
+    const HeuristicWeights tuned = tuneHeuristic(rules, references, config, [](const TuneGeneration& g) {
+        if (g.generation % 8 != 0 && g.generation != 1) return;
+        std::cout << "    generation " << std::setw(2) << g.generation << ": best " << std::setprecision(3)
+                  << g.bestFitness << ", mean " << g.meanFitness << ", " << std::setprecision(2) << g.seconds << " s\n";
+    });
+    std::cout << "  tuned weights (build | block):";
+    for (std::size_t w = 0; w < tuned.size(); ++w) {
+        std::cout << (w == static_cast<std::size_t>(rules.k) ? " |" : "") << " " << std::setprecision(2) << tuned[w];
+    }
+    std::cout << "\n";
+    // Held-out openings, more of them
+    std::cout << "  fitness on 256 fresh openings: tuned " << std::setprecision(3)
+              << heuristicFitness(rules, tuned, references, 256, 4, 99) << ", hand-picked "
+              << heuristicFitness(rules, hand, references, 256, 4, 99) << "\n";
+
+    // One generation's tournament with more and more threads
+    for (int threads : {1, 2, 4}) {
+        TuneConfig timing = config;
+        timing.generations = 1;
+        timing.threads = threads;
+        const double seconds = secondsFor([&]() { tuneHeuristic(rules, references, timing); });
+        std::cout << "  one generation, " << threads << " threads: " << std::setprecision(2) << seconds << " s\n";
+    }
+}
+
+// ============================================================================
+// Huge pages and prefetching
+// ============================================================================
+
+void benchTableMemory() {
+    // Random probes into a 1GB table: every probe misses the cache, and with
+    // 4KB pages nearly every probe misses the TLB too
+    const int probes = 20000000;
+    for (bool largePages : {false, true}) {
+        TranspositionTable table = makeTable(1024, largePages);
+        for (bool prefetch : {false, true}) {
+            std::uint64_t hits = 0;
+            std::uint64_t key = 12345;
+            double seconds = secondsFor([&]() {
+                // With prefetch, ask for the slot 8 probes ahead of time
+                std::uint64_t ahead = key;
+                for (int i = 0; prefetch && i < 8; ++i) tablePrefetch(table, ahead = splitMix64(ahead));
+                for (int i = 0; i < probes; ++i) {
+                    key = splitMix64(key);
+                    if (prefetch) tablePrefetch(table, ahead = splitMix64(ahead));
+                    hits += tableProbe(table, key).has_value();
+                }
+            });
+            std::cout << "  1GB table, " << std::setw(21) << tablePagesName(table.pages)
+                      << (prefetch ? ", prefetch:    " : ", no prefetch: ")
+                      << std::setprecision(1) << seconds * 1e9 / probes << " ns/probe"
+                      << (hits ? " (!)" : "") << "\n";
+        }
+    }
+
+    // Whole searches: node rate with a small and a large table
+    const MnkRules rules = makeRules(5, 5, 4);
+    for (const auto& [megabytes, largePages] : {std::pair{16, false}, std::pair{1024, false}, std::pair{1024, true}}) {
+        TranspositionTable table = makeTable(megabytes, largePages);
+        SearchResult result;
+        double seconds = secondsFor([&]() {
+            result = searchPosition(rules, mnkEmpty(), table, SearchLimits{10, 1, 0.0});
+        });
+        std::cout << "  5x5 k=4 depth 10, " << std::setw(4) << megabytes << "MB table, "
+                  << std::setw(21) << tablePagesName(table.pages) << ": "
+                  << std::setprecision(2) << result.nodes / seconds / 1e6 << " M nodes/s\n";
+    }
+}
+
+// ============================================================================
+// Bloom-filtered visited set
+// ============================================================================
+
+void benchBloomVisited() {
+    // Every 4x4 k=4 position with up to 11 pieces, depth first. Each new
+    // position is followed by several duplicate visits from other move orders.
+    const MnkRules rules = makeRules(4, 4, 4);
+    const int maxPly = 11;
+
+    std::unordered_set<std::uint64_t> plain;
+    std::uint64_t plainCount = 0;
+    const std::function<void(const MnkState&, int)> walk = [&](const MnkState& s, int left) {
+        if (!plain.insert(s.key).second) return;
+        ++plainCount;
+        for (int cell : left > 0 ? mnkValidMoves(rules, s) : std::vector<int>{}) walk(mnkPlay(rules, s, cell), left - 1);
+    };
+    double plainSeconds = secondsFor([&]() { walk(mnkEmpty(), maxPly); });
+    std::cout << "  4x4 k=4 up to " << maxPly << " pieces: " << plainCount << " positions\n"
+              << "    std::unordered_set:          " << std::setprecision(2) << plainSeconds << " s\n";
+
+    for (double rate : {1.0, 0.01, 0.001, 0.0001}) {
+        VisitedSet visited = makeVisitedSet(plainCount, rate);
+        std::uint64_t count = 0;
+        double seconds = secondsFor([&]() { count = enumerateReachable(rules, maxPly, visited); });
+        const VisitedStats& st = visited.stats;
+        if (!visited.filtered) {
+            std::cout << "    sorted store, no filter:     " << seconds << " s, "
+                      << st.exactProbes << " exact probes\n";
+            continue;
+        }
+        std::cout << "    sorted store, filter " << std::setprecision(4) << rate << ": "
+                  << std::setprecision(2) << seconds << " s, " << st.exactProbes << " exact probes, "
+                  << (visited.filter.blocks.size() * sizeof(BloomBlock)) / 1024 << " KB filter"
+                  << (visited.filter.simd ? " (AVX2)" : " (scalar)") << (count != plainCount ? " COUNT MISMATCH" : "") << "\n"
+                  << "      " << st.filterRejects << " new positions answered by the filter alone, "
+                  << st.falsePositives << " false positives\n"
+                  << "      false-positive rate: measured " << std::setprecision(5)
+                  << measuredFalsePositiveRate(st) << ", expected at full load "
+                  << bloomFalsePositiveRate(visited.filter) << "\n";
+    }
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+constexpr Benchmark benchmarks[] = {
+    {"zobrist-throughput", benchZobristThroughput},
+    {"zobrist-collisions", benchZobristCollisions},
+    {"perft", benchPerft},
+    {"lazy-smp", benchLazySmp},
+    {"ybwc", benchYbwc},
+    {"move-ordering", benchMoveOrdering},
+    {"root-drivers", benchRootDrivers},
+    {"leaf-eval", benchLeafEval},
+    {"opening-book", benchOpeningBook},
+    {"pondering", benchPondering},
+    {"mcts-reuse", benchMctsReuse},
+    {"mcts-rave", benchMctsRave},
+    {"td-training", benchTdTraining},
+    {"td-hogwild", benchTdHogwild},
+    {"menace", benchMenace},
+    {"mlp-inference", benchMlpInference},
+    {"batched-inference", benchBatchedInference},
+    {"nnue", benchNnue},
+    {"alphazero", benchAlphaZero},
+    {"replay-store", benchReplayStore},
+    {"feature-extraction", benchFeatureExtraction},
+    {"genetic-tuning", benchGeneticTuning},
+    {"table-memory", benchTableMemory},
+    {"bloom-visited", benchBloomVisited},
+};
+
+int main(int argc, char** argv) {
+    const std::string filter = argc > 1 ? argv[1] : "";
+    std::cout << std::fixed;
+    for (const Benchmark& b : benchmarks) {
+        if (std::strstr(b.name, filter.c_str()) != nullptr) {
+            std::cout << "[" << b.name << "]\n";
+            b.run();
+            std::cout << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "bloom.h"
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICTACTOE_X86 1
+#endif
+
+// ============================================================================
+// SIMD AND RUNTIME DISPATCH
+//
+// SIMD ("single instruction, multiple data") instructions work on several
+// values at once: one AVX2 instruction multiplies eight 32-bit numbers.
+// We reach them through "intrinsics" - functions like _mm256_mullo_epi32
+// that the compiler turns into exactly one instruction each.
+//
+// Not every x86 CPU has AVX2, so the AVX2 versions are compiled separately
+// with __attribute__((target("avx2"))) and only called after
+// __builtin_cpu_supports("avx2") says the running CPU can execute them.
+// Every kernel also has a plain C++ version that works everywhere.
+// ============================================================================
+
+// One odd multiplier per lane (the first eight are the Parquet format's salts)
+alignas(32) constexpr std::uint32_t bloomSalts[16] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U,
+    0x9e3779b1U, 0x85ebca77U, 0xc2b2ae3dU, 0x27d4eb2fU,
+    0x165667b1U, 0xd3a2646bU, 0xfd7046c5U, 0xb55a4f09U,
+};
+
+// Helper: mix a key so that nearby keys land in unrelated blocks
+std::uint64_t bloomHash(std::uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    return key ^ (key >> 33);
+}
+
+// Helper: which block a hash selects (multiply-shift instead of modulo)
+std::size_t bloomBlockIndex(std::size_t blockCount, std::uint64_t hash) {
+    return static_cast<std::size_t>(((hash >> 32) * blockCount) >> 32);
+}
+
+// Helper: bit selected in lane i
+std::uint32_t laneMask(std::uint32_t hash, int lane) {
+    return std::uint32_t{1} << ((hash * bloomSalts[lane]) >> 27);
+}
+
+void insertScalar(BloomBlock& block, std::uint32_t hash) {
+    for (int i = 0; i < 16; ++i) block.lanes[i] |= laneMask(hash, i);
+}
+
+bool containsScalar(const BloomBlock& block, std::uint32_t hash) {
+    bool all = true;
+    for (int i = 0; i < 16; ++i) all &= (block.lanes[i] & laneMask(hash, i)) != 0;
+    return all;
+}
+
+#ifdef TICTACTOE_X86
+// Eight lane masks at once: (hash * salt) >> 27 gives a bit number 0..31
+__attribute__((target("avx2")))
+__m256i laneMasksAvx2(std::uint32_t hash, int half) {
+    const __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i*>(bloomSalts + 8 * half));
+    const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts), 27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+}
+
+__attribute__((target("avx2")))
+void insertAvx2(BloomBlock& block, std::uint32_t hash) {
+    for (int half = 0; half < 2; ++half) {
+        __m256i* lanes = reinterpret_cast<__m256i*>(block.lanes + 8 * half);
+        _mm256_store_si256(lanes, _mm256_or_si256(_mm256_load_si256(lanes), laneMasksAvx2(hash, half)));
+    }
+}
+
+__attribute__((target("avx2")))
+bool containsAvx2(const BloomBlock& block, std::uint32_t hash) {
+    // testc(a, b) is 1 when every bit set in b is also set in a
+    return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block.lanes)),
+                              laneMasksAvx2(hash, 0)) &&
+           _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(block.lanes + 8)),
+                              laneMasksAvx2(hash, 1));
+}
+#endif
+
+// Helper: can this CPU run the AVX2 kernels?
+bool cpuHasAvx2() {
+#ifdef TICTACTOE_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+// ============================================================================
+// Bloom Filter
+// ============================================================================
+
+BloomFilter makeBloomFilterBlocks(std::size_t blockCount) {
+    return BloomFilter{std::vector<BloomBlock>(std::max<std::size_t>(blockCount, 1), BloomBlock{}), 0, cpuHasAvx2()};
+}
+
+double bloomExpectedFalsePositiveRate(std::size_t blockCount, std::uint64_t keys) {
+    // Keys per block follow a Poisson distribution with mean lambda. A block
+    // holding j keys answers "maybe" for a new key when all 16 of its lane
+    // bits are set, and each is set with probability 1 - (31/32)^j.
+    const double lambda = static_cast<double>(keys) / static_cast<double>(std::max<std::size_t>(blockCount, 1));
+    const int limit = static_cast<int>(lambda + 12.0 * std::sqrt(lambda) + 32.0);
+    double rate = 0.0;
+    for (int j = 0; j <= limit; ++j) {
+        const double poisson = std::exp(j * std::log(std::max(lambda, 1e-300)) - lambda - std::lgamma(j + 1.0));
+        rate += poisson * std::pow(1.0 - std::pow(31.0 / 32.0, j), 16);
+    }
+    return rate;
+}
+
+BloomFilter makeBloomFilter(std::uint64_t expectedKeys, double falsePositiveRate) {
+    // Binary search for the fewest blocks that meet the target
+    std::size_t low = 1;
+    std::size_t high = static_cast<std::size_t>(std::max<std::uint64_t>(expectedKeys, 1));
+    while (low < high) {
+        const std::size_t mid = low + (high - low) / 2;
+        if (bloomExpectedFalsePositiveRate(mid, expectedKeys) <= falsePositiveRate) high = mid;
+        else low = mid + 1;
+    }
+    return makeBloomFilterBlocks(low);
+}
+
+void bloomInsert(BloomFilter& filter, std::uint64_t key) {
+    const std::uint64_t hash = bloomHash(key);
+    BloomBlock& block = filter.blocks[bloomBlockIndex(filter.blocks.size(), hash)];
+#ifdef TICTACTOE_X86
+    if (filter.simd) {
+        insertAvx2(block, static_cast<std::uint32_t>(hash));
+    } else {
+        insertScalar(block, static_cast<std::uint32_t>(hash));
+    }
+#else
+    insertScalar(block, static_cast<std::uint32_t>(hash));
+#endif
+    ++filter.inserted;
+}
+
+bool bloomMayContain(const BloomFilter& filter, std::uint64_t key) {
+    const std::uint64_t hash = bloomHash(key);
+    const BloomBlock& block = filter.blocks[bloomBlockIndex(filter.blocks.size(), hash)];
+#ifdef TICTACTOE_X86
+    return filter.simd ? containsAvx2(block, static_cast<std::uint32_t>(hash))
+                       : containsScalar(block, static_cast<std::uint32_t>(hash));
+#else
+    return containsScalar(block, static_cast<std::uint32_t>(hash));
+#endif
+}
+
+double bloomFalsePositiveRate(const BloomFilter& filter) {
+    return bloomExpectedFalsePositiveRate(filter.blocks.size(), filter.inserted);
+}
+
+// ============================================================================
+// Visited Set
+// ============================================================================
+
+VisitedSet makeVisitedSet(std::uint64_t expectedKeys, double falsePositiveRate) {
+    return falsePositiveRate >= 1.0
+        ? VisitedSet{false, makeBloomFilterBlocks(1), {}, {}, std::size_t{1} << 16, {}}
+        : VisitedSet{true, makeBloomFilter(expectedKeys, falsePositiveRate), {}, {}, std::size_t{1} << 16, {}};
+}
+
+bool operator<(const VisitedEntry& a, const VisitedEntry& b) {
+    return std::tie(a.key, a.x, a.o) < std::tie(b.key, b.x, b.o);
+}
+
+bool operator==(const VisitedEntry& a, const VisitedEntry& b) {
+    return a.key == b.key && a.x == b.x && a.o == b.o;
+}
+
+// Helper: merge the pending entries into the sorted exact store. The batch
+// grows with the store so the total merging work stays linear-ish.
+void flushPending(VisitedSet& set) {
+    std::vector<VisitedEntry> batch(set.pending.begin(), set.pending.end());
+    std::sort(batch.begin(), batch.end());
+    const std::size_t middle = set.sorted.size();
+    set.sorted.insert(set.sorted.end(), batch.begin(), batch.end());
+    std::inplace_merge(set.sorted.begin(), set.sorted.begin() + static_cast<std::ptrdiff_t>(middle), set.sorted.end());
+    set.pending.clear();
+    set.pendingLimit = std::max(set.pendingLimit, set.sorted.size() / 4);
+}
+
+bool visitedInsert(VisitedSet& set, const MnkState& state) {
+    const VisitedEntry entry{state.key, state.x, state.o};
+    ++set.stats.inserts;
+    if (set.filtered && !bloomMayContain(set.filter, entry.key)) {
+        ++set.stats.filterRejects;
+    } else {
+        ++set.stats.exactProbes;
+        if (set.pending.count(entry) != 0 || std::binary_search(set.sorted.begin(), set.sorted.end(), entry)) {
+            return false;
+        }
+        set.stats.falsePositives += set.filtered;
+    }
+    if (set.filtered) bloomInsert(set.filter, entry.key);
+    set.pending.insert(entry);
+    if (set.pending.size() >= set.pendingLimit) flushPending(set);
+    return true;
+}
+
+std::size_t visitedSize(const VisitedSet& set) {
+    return set.sorted.size() + set.pending.size();
+}
+
+double measuredFalsePositiveRate(const VisitedStats& stats) {
+    const std::uint64_t fresh = stats.filterRejects + stats.falsePositives;
+    return fresh == 0 ? 0.0 : static_cast<double>(stats.falsePositives) / static_cast<double>(fresh);
+}
+
+// ============================================================================
+// Enumeration
+// ============================================================================
+
+// Helper: depth-first walk for enumerateReachable
+std::uint64_t enumerateFrom(const MnkRules& rules, const MnkState& state, int pliesLeft, VisitedSet& visited) {
+    std::uint64_t count = 0;
+    if (visitedInsert(visited, state)) {
+        count = 1;
+        for (Bitboard b = (pliesLeft > 0 && !mnkIsGameOver(rules, state)) ? emptyCells(rules, state) : 0;
+             b != 0; b &= b - 1) {
+            count += enumerateFrom(rules, mnkPlay(rules, state, __builtin_ctzll(b)), pliesLeft - 1, visited);
+        }
+    }
+    return count;
+}
+
+std::uint64_t enumerateReachable(const MnkRules& rules, int maxPly, VisitedSet& visited) {
+    return enumerateFrom(rules, mnkEmpty(), maxPly, visited);
+}
@@ -0,0 +1,129 @@
+#ifndef TICTACTOE_BLOOM_H
+#define TICTACTOE_BLOOM_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// BLOOM FILTERS
+//
+// A Bloom filter answers "have I seen this key before?" using a few bits per
+// key instead of storing the keys. Its answers are:
+//   "no"    - definitely never inserted
+//   "maybe" - probably inserted, but it could be a FALSE POSITIVE
+//
+// Inserting a key sets a handful of bits chosen by hashing it; looking a key
+// up checks whether all of those bits are set. More bits per key means fewer
+// false positives.
+//
+// BLOCKED Bloom filter: all of a key's bits live in ONE 64-byte block - one
+// CPU cache line - so a lookup costs a single cache miss instead of one per
+// bit. The block is 16 lanes of 32 bits and every key sets exactly one bit in
+// each lane. The 16 bit positions come from one multiply-and-shift per lane
+// with a different odd constant ("salt") per lane - 16 independent
+// multiplications, which is exactly what SIMD instructions do in one go.
+// ============================================================================
+
+struct alignas(64) BloomBlock {
+    std::uint32_t lanes[16];
+};
+
+struct BloomFilter {
+    std::vector<BloomBlock> blocks;
+    std::uint64_t inserted = 0;   // keys inserted (for the false-positive estimate)
+    bool simd = false;            // AVX2 kernels in use
+};
+
+// Filter with room for 'expectedKeys' at (about) the given false-positive
+// rate. Uses AVX2 when the CPU supports it.
+BloomFilter makeBloomFilter(std::uint64_t expectedKeys, double falsePositiveRate);
+
+// Filter with an explicit number of 64-byte blocks
+BloomFilter makeBloomFilterBlocks(std::size_t blockCount);
+
+// Insert a key / test a key ("maybe" = true)
+void bloomInsert(BloomFilter& filter, std::uint64_t key);
+bool bloomMayContain(const BloomFilter& filter, std::uint64_t key);
+
+// Expected false-positive rate with 'keys' keys inserted
+double bloomExpectedFalsePositiveRate(std::size_t blockCount, std::uint64_t keys);
+
+// Expected false-positive rate for the keys inserted so far
+double bloomFalsePositiveRate(const BloomFilter& filter);
+
+// ============================================================================
+// VISITED SET
+//
+// Exact "seen before?" check for enumerations too big for a plain hash set.
+// The exact store is a big SORTED array (the in-memory stand-in for a sorted
+// file on disk): compact, but every probe is a binary search with a cache
+// miss (or a disk seek) at almost every step. New entries go to a small hash
+// set first and are merged into the sorted array in batches.
+//
+// Entries are whole positions, not just Zobrist keys: two different positions
+// can share a key, and a set of keys alone would silently merge them. The key
+// still does the work - it orders the entries, hashes them and feeds the
+// filter - and the bitboards only break ties, so the answers are exact.
+//
+// The Bloom filter sits in front. Probing the exact store for a key that
+// ISN'T there is the worst case (the search runs all the way down before
+// failing), and every new position in an enumeration is such a key. For those
+// the filter says "definitely not seen" after one cache miss and the exact
+// probe is skipped. Only "maybe" answers - real duplicates and the occasional
+// false positive - go to the exact store.
+// ============================================================================
+
+struct VisitedStats {
+    std::uint64_t inserts = 0;          // visitedInsert calls
+    std::uint64_t filterRejects = 0;    // answered "new" by the filter alone
+    std::uint64_t exactProbes = 0;      // had to check the exact store
+    std::uint64_t falsePositives = 0;   // ...and the key turned out to be new
+};
+
+// One position in the exact store, ordered by key first
+struct VisitedEntry {
+    std::uint64_t key;
+    Bitboard x;
+    Bitboard o;
+};
+
+bool operator<(const VisitedEntry& a, const VisitedEntry& b);
+bool operator==(const VisitedEntry& a, const VisitedEntry& b);
+
+struct VisitedEntryHash {
+    std::size_t operator()(const VisitedEntry& e) const { return static_cast<std::size_t>(e.key); }
+};
+
+struct VisitedSet {
+    bool filtered;                                              // false: every insert probes the exact store
+    BloomFilter filter;
+    std::vector<VisitedEntry> sorted;                           // exact store
+    std::unordered_set<VisitedEntry, VisitedEntryHash> pending; // recent entries, not merged yet
+    std::size_t pendingLimit;
+    VisitedStats stats;
+};
+
+// Visited set sized for 'expectedKeys' with the given filter false-positive
+// rate. A rate of 1 or more means no filter at all (for comparison).
+VisitedSet makeVisitedSet(std::uint64_t expectedKeys, double falsePositiveRate);
+
+// Insert a position; returns true if it had NOT been seen before
+bool visitedInsert(VisitedSet& set, const MnkState& state);
+
+// Number of distinct positions inserted
+std::size_t visitedSize(const VisitedSet& set);
+
+// Measured false-positive rate of the filter: false positives / keys that
+// were actually new
+double measuredFalsePositiveRate(const VisitedStats& stats);
+
+// Number of distinct m,n,k positions reachable within maxPly moves, found by
+// a depth-first walk that skips every position already in 'visited'. Unlike
+// countDistinctPositions (mnk.h) it never holds a whole layer, only the
+// visited set, whose filter answers most "seen before?" questions on its own.
+std::uint64_t enumerateReachable(const MnkRules& rules, int maxPly, VisitedSet& visited);
+
+#endif // TICTACTOE_BLOOM_H
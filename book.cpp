@@ -0,0 +1,213 @@
+#include "book.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Canonical Positions
+// ============================================================================
+
+// Helper: the key a position is filed under
+std::uint64_t bookKey(const MnkRules& rules, const MnkState& state) {
+    const auto [cx, co] = canonicalBitboards(rules, state.x, state.o);
+    return computeKey(cx, co);
+}
+
+// Helper: one canonical representative of every unfinished position with
+// fewer than 'plies' pieces, in ply order
+std::vector<MnkState> bookPositions(const MnkRules& rules, int plies) {
+    std::vector<MnkState> positions;
+    std::vector<MnkState> layer{mnkEmpty()};
+    for (int ply = 0; ply < plies && !layer.empty(); ++ply) {
+        std::vector<MnkState> next;
+        std::unordered_set<std::uint64_t> seen;
+        for (const MnkState& state : layer) {
+            if (mnkIsGameOver(rules, state)) continue;
+            positions.push_back(state);
+            for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+                const MnkState child = mnkPlay(rules, state, __builtin_ctzll(b));
+                const auto [cx, co] = canonicalBitboards(rules, child.x, child.o);
+                if (seen.insert(computeKey(cx, co)).second) next.push_back(stateFromBitboards(rules, cx, co));
+            }
+        }
+        layer = std::move(next);
+    }
+    return positions;
+}
+
+// ============================================================================
+// Building
+// ============================================================================
+
+// Helper: score of playing 'cell', from the mover's point of view. The
+// child's win/loss distance is one ply shorter than ours.
+int moveScore(const MnkRules& rules, const MnkState& state, int cell,
+              TranspositionTable& table, const SearchLimits& limits) {
+    const MnkState child = mnkPlay(rules, state, cell);
+    if (child.winner != Cell::Empty) return winScore - 1;
+    if (child.moves == rules.cells) return 0;
+    SearchLimits childLimits = limits;
+    childLimits.maxDepth = std::max(1, limits.maxDepth - 1);
+    const int score = searchPosition(rules, child, table, childLimits).score;
+    return score > winThreshold ? -(score - 1) : score < -winThreshold ? -(score + 1) : -score;
+}
+
+Book buildBook(const MnkRules& rules, const BookConfig& config,
+               const std::function<void(std::size_t, std::size_t)>& progress) {
+    const std::vector<MnkState> positions = bookPositions(rules, config.plies);
+    TranspositionTable table = makeTable(config.tableMegabytes);
+    std::vector<BookEntry> entries;
+
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const MnkState& state = positions[i];
+        std::vector<std::pair<int, int>> scored;   // (score, cell)
+        for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+            const int cell = __builtin_ctzll(b);
+            scored.emplace_back(moveScore(rules, state, cell, table, config.limits), cell);
+        }
+        const int best = std::max_element(scored.begin(), scored.end())->first;
+        const std::uint64_t key = computeKey(state.x, state.o);
+        for (const auto& [score, cell] : scored) {
+            if (score < best - std::max(config.margin, 0)) continue;
+            // The best move gets margin + 1; each point worse loses one
+            const int weight = std::clamp(std::max(config.margin, 0) + 1 - (best - score), 1, 65535);
+            entries.push_back(BookEntry{key, static_cast<std::uint16_t>(cell), static_cast<std::uint16_t>(weight),
+                                        static_cast<std::int16_t>(score),
+                                        static_cast<std::uint16_t>(config.limits.maxDepth)});
+        }
+        if (progress) progress(i + 1, positions.size());
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.weight != b.weight ? a.weight > b.weight : a.move < b.move;
+    });
+    const std::size_t count = entries.size();
+    BookEntry* data = new BookEntry[count];
+    std::copy(entries.begin(), entries.end(), data);
+    return Book{rules, count, std::shared_ptr<const BookEntry>(data, std::default_delete<BookEntry[]>())};
+}
+
+// ============================================================================
+// Files
+//
+// Layout: a 32-byte header, then the sorted 16-byte entries.
+// ============================================================================
+
+struct BookHeader {
+    char magic[8];
+    std::int32_t rows;
+    std::int32_t cols;
+    std::int32_t k;
+    std::int32_t reserved;
+    std::uint64_t entries;
+};
+
+constexpr char bookMagic[8] = {'T', 'T', 'T', 'B', 'O', 'O', 'K', '1'};
+
+bool writeBook(const Book& book, const std::string& path) {
+    BookHeader header{{}, book.rules.rows, book.rules.cols, book.rules.k, 0, book.size};
+    std::memcpy(header.magic, bookMagic, sizeof header.magic);
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    out.write(reinterpret_cast<const char*>(book.entries.get()),
+              static_cast<std::streamsize>(book.size * sizeof(BookEntry)));
+    return static_cast<bool>(out);
+}
+
+// Helper: check a header read from disk against the file size
+bool validBookHeader(const BookHeader& header, std::uint64_t fileSize) {
+    return std::memcmp(header.magic, bookMagic, sizeof header.magic) == 0 &&
+           header.rows > 0 && header.cols > 0 && header.rows * header.cols <= maxCells &&
+           fileSize == sizeof(BookHeader) + header.entries * sizeof(BookEntry);
+}
+
+std::optional<Book> openBook(const std::string& path) {
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct stat info {};
+    const bool statOk = fstat(fd, &info) == 0 && static_cast<std::uint64_t>(info.st_size) >= sizeof(BookHeader);
+    void* mapping = statOk ? mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) return std::nullopt;
+
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    const BookHeader* header = static_cast<const BookHeader*>(mapping);
+    if (!validBookHeader(*header, size)) {
+        munmap(mapping, size);
+        return std::nullopt;
+    }
+    // The 32-byte header keeps the 16-byte entries aligned
+    const BookEntry* entries = reinterpret_cast<const BookEntry*>(static_cast<const char*>(mapping) + sizeof(BookHeader));
+    return Book{makeRules(header->rows, header->cols, header->k), header->entries,
+        std::shared_ptr<const BookEntry>(entries, [mapping, size](const BookEntry*) { munmap(mapping, size); })};
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    const std::uint64_t size = in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+    BookHeader header{};
+    in.seekg(0);
+    if (!in || size < sizeof header || !in.read(reinterpret_cast<char*>(&header), sizeof header) ||
+        !validBookHeader(header, size)) {
+        return std::nullopt;
+    }
+    std::shared_ptr<BookEntry> entries(new BookEntry[header.entries], std::default_delete<BookEntry[]>());
+    in.read(reinterpret_cast<char*>(entries.get()), static_cast<std::streamsize>(header.entries * sizeof(BookEntry)));
+    return in ? std::optional{Book{makeRules(header.rows, header.cols, header.k), header.entries, entries}}
+              : std::nullopt;
+#endif
+}
+
+// ============================================================================
+// Probing
+// ============================================================================
+
+// Helper: index of the first entry with a key >= 'key'. Interpolation
+// narrows the range while it is big; binary search finishes it off.
+std::size_t firstEntry(const BookEntry* entries, std::size_t size, std::uint64_t key) {
+    std::size_t low = 0;
+    std::size_t high = size;   // the answer is in [low, high]
+    while (high - low > 16) {
+        const std::uint64_t lowKey = entries[low].key;
+        const std::uint64_t highKey = entries[high - 1].key;
+        if (key <= lowKey) return low;
+        if (key > highKey) return high;
+        const double fraction = static_cast<double>(key - lowKey) / static_cast<double>(highKey - lowKey);
+        const std::size_t guess = std::min(high - 1, low + static_cast<std::size_t>(fraction * static_cast<double>(high - 1 - low)));
+        if (entries[guess].key < key) low = guess + 1;
+        else high = guess;
+    }
+    return static_cast<std::size_t>(std::lower_bound(entries + low, entries + high, key,
+        [](const BookEntry& e, std::uint64_t k) { return e.key < k; }) - entries);
+}
+
+std::vector<BookMove> bookProbe(const Book& book, const MnkState& state) {
+    const MnkRules& rules = book.rules;
+    const std::uint64_t key = bookKey(rules, state);
+    const BookEntry* entries = book.entries.get();
+    const int symmetry = canonicalSymmetry(rules, state.x, state.o);
+
+    std::vector<BookMove> moves;
+    for (std::size_t i = firstEntry(entries, book.size, key); i < book.size && entries[i].key == key; ++i) {
+        // Undo the symmetry: find the cell that lands on the stored move
+        const std::vector<int>& image = rules.symmetries[symmetry];
+        const int cell = static_cast<int>(std::find(image.begin(), image.end(), entries[i].move) - image.begin());
+        moves.push_back(BookMove{cell, entries[i].weight, entries[i].score});
+    }
+    return moves;
+}
+
+MnkStrategy bookStrategy(Book book, MnkStrategy fallback) {
+    return [book, fallback](const MnkRules& rules, const MnkState& state) {
+        // A book for different rules is simply never "in book"
+        const bool sameRules = rules.rows == book.rules.rows && rules.cols == book.rules.cols && rules.k == book.rules.k;
+        const std::vector<BookMove> moves = sameRules ? bookProbe(book, state) : std::vector<BookMove>{};
+        return moves.empty() ? fallback(rules, state) : moves.front().move;
+    };
+}
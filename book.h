@@ -0,0 +1,80 @@
+#ifndef TICTACTOE_BOOK_H
+#define TICTACTOE_BOOK_H
+
+#include "mnk.h"
+#include "search.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// OPENING BOOKS
+//
+// On a big board the first few moves are the most expensive to search (the
+// whole game is still ahead) and also the most repetitive (every game starts
+// from the same empty board). So we search them ONCE, offline, as deeply as
+// we like, and save the answers in a file: an opening book.
+//
+// Entries are keyed by the Zobrist key of the position's CANONICAL form
+// (see canonicalBitboards), so one entry serves all 4 or 8 symmetric images
+// of a position. Moves are stored in the canonical position's coordinates
+// and mapped back through the symmetry when probing.
+//
+// The file is a header plus an array of 16-byte entries SORTED by key. A
+// position with several good moves has several adjacent entries. Opening it
+// is one mmap(); a probe is a search of the sorted array. The keys are hash
+// values, spread evenly over 0..2^64, so INTERPOLATION search works well:
+// instead of halving the range, guess where the key should be from its
+// value - like opening a dictionary near the back for a word starting with
+// "w". It needs a handful of probes where binary search needs ~log2(n).
+// ============================================================================
+
+struct BookEntry {
+    std::uint64_t key;      // Zobrist key of the canonical position
+    std::uint16_t move;     // cell, in canonical coordinates
+    std::uint16_t weight;   // higher = better; the best move has the highest
+    std::int16_t score;     // search score of the move, for the side to move
+    std::uint16_t depth;    // depth it was searched to
+};
+static_assert(sizeof(BookEntry) == 16, "book entries are 16 bytes on disk");
+
+// A book in memory or mapped from a file. Copies share the entries.
+struct Book {
+    MnkRules rules;
+    std::uint64_t size;                         // number of entries
+    std::shared_ptr<const BookEntry> entries;   // sorted by key, best move first
+};
+
+struct BookConfig {
+    int plies = 4;           // cover every position with fewer pieces than this
+    SearchLimits limits;     // how hard to search each move
+    int margin = 0;          // also keep moves scoring within this of the best
+    std::size_t tableMegabytes = 256;
+};
+
+// A move found in the book, in the probed position's own coordinates
+struct BookMove {
+    int move;
+    int weight;
+    int score;
+};
+
+// Search every position reachable in fewer than config.plies plies (one per
+// symmetry class) and keep its best moves. 'progress', if set, is called
+// after each position with (done, total).
+Book buildBook(const MnkRules& rules, const BookConfig& config,
+               const std::function<void(std::size_t, std::size_t)>& progress = nullptr);
+
+// Save to / map from a file
+bool writeBook(const Book& book, const std::string& path);
+std::optional<Book> openBook(const std::string& path);
+
+// The book's moves for a position, best first (empty if it is not in the book)
+std::vector<BookMove> bookProbe(const Book& book, const MnkState& state);
+
+// Play the book's best move while the game is in the book, then 'fallback'
+MnkStrategy bookStrategy(Book book, MnkStrategy fallback);
+
+#endif // TICTACTOE_BOOK_H
@@ -0,0 +1,77 @@
+#include "engine.h"
+#include <optional>
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<Engine> makeEngine(const MnkRules& rules, std::shared_ptr<TranspositionTable> table,
+                                   SearchLimits limits, bool ponder) {
+    // Engine is an aggregate; make_shared can't brace-initialize one in C++17
+    return std::shared_ptr<Engine>(new Engine{rules, std::move(table), limits, ponder},
+        [](Engine* engine) {
+            engineStopPondering(*engine);
+            delete engine;
+        });
+}
+
+void engineStopPondering(Engine& engine) {
+    if (engine.pondering.valid()) {
+        engine.cancel.store(true, std::memory_order_relaxed);
+        engine.pondering.get();
+    }
+}
+
+// Helper: we just moved into 'state'. Guess the reply from the table and
+// start searching the position after it in the background.
+void startPondering(Engine& engine, const MnkState& state) {
+    if (!engine.ponder || mnkIsGameOver(engine.rules, state)) return;
+    const std::optional<TableEntry> entry = tableProbe(*engine.table, state.key);
+    const int reply = entry ? entry->move : -1;
+    if (reply < 0 || ((emptyCells(engine.rules, state) >> reply) & 1) == 0) return;
+
+    engine.ponderState = mnkPlay(engine.rules, state, reply);
+    if (mnkIsGameOver(engine.rules, engine.ponderState)) return;
+
+    // No clock while pondering - it runs until the opponent moves
+    SearchLimits limits = engine.limits;
+    limits.maxSeconds = 0.0;
+    limits.cancel = &engine.cancel;
+    engine.cancel.store(false, std::memory_order_relaxed);
+    engine.ponderStart = Clock::now();
+    engine.pondering = std::async(std::launch::async, [&engine, limits, target = engine.ponderState]() {
+        return searchPosition(engine.rules, target, *engine.table, limits);
+    });
+}
+
+SearchResult engineMove(Engine& engine, const MnkState& state) {
+    std::optional<SearchResult> pondered;
+    if (engine.pondering.valid()) {
+        if (state.x == engine.ponderState.x && state.o == engine.ponderState.o) {
+            ++engine.stats.ponderHits;
+            // The pondering gets our usual thinking time, counted from when
+            // it started - so after a long opponent think, nothing more
+            if (engine.limits.maxSeconds > 0.0) {
+                const auto remaining = std::chrono::duration<double>(engine.limits.maxSeconds)
+                                     - (Clock::now() - engine.ponderStart);
+                if (engine.pondering.wait_for(remaining) != std::future_status::ready) {
+                    engine.cancel.store(true, std::memory_order_relaxed);
+                }
+            }
+            pondered = engine.pondering.get();
+        } else {
+            ++engine.stats.ponderMisses;
+            engineStopPondering(engine);
+        }
+    }
+
+    // A pondered search cancelled before it finished depth 1 has no answer
+    const SearchResult result = pondered && pondered->depth > 0
+        ? *pondered
+        : searchPosition(engine.rules, state, *engine.table, engine.limits);
+    ++engine.stats.moves;
+    if (result.move >= 0) startPondering(engine, mnkPlay(engine.rules, state, result.move));
+    return result;
+}
+
+MnkStrategy engineStrategy(std::shared_ptr<Engine> engine) {
+    return [engine](const MnkRules&, const MnkState& state) { return engineMove(*engine, state).move; };
+}
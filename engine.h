@@ -0,0 +1,71 @@
+#ifndef TICTACTOE_ENGINE_H
+#define TICTACTOE_ENGINE_H
+
+#include "search.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+
+// ============================================================================
+// PONDERING
+//
+// In a live game the engine sits idle while the opponent thinks - and a
+// human opponent thinks for seconds. PONDERING puts that time to work:
+//
+//   1. We play our move. Our search already knows the reply it expects
+//      (the best move stored in the table for the position we just made).
+//   2. While the opponent thinks, a background thread searches the position
+//      AFTER that expected reply, as if it were already our turn.
+//   3. The opponent moves.
+//        PONDER HIT  - they played the expected reply. The background search
+//                      has been working on exactly our position; it gets the
+//                      rest of our normal thinking time (none, if it has
+//                      already run that long) and its answer is ours.
+//        PONDER MISS - cancel it and search the real position. Not all is
+//                      lost: the shared transposition table keeps whatever
+//                      the pondering found about positions the two share.
+//
+// The background search runs through std::async, which returns a
+// std::future: a handle to a result that isn't ready yet. future.wait_for()
+// waits at most a given time; future.get() waits for and takes the result.
+// Cancelling is one atomic flag the search checks as it goes.
+// ============================================================================
+
+struct EngineStats {
+    std::uint64_t moves = 0;
+    std::uint64_t ponderHits = 0;
+    std::uint64_t ponderMisses = 0;
+};
+
+// The engine owns a background search while pondering, and the atomic flag
+// makes it impossible to copy or move: create it with makeEngine, whose
+// pointer cancels any pondering when the last copy goes away.
+struct Engine {
+    MnkRules rules;
+    std::shared_ptr<TranspositionTable> table;
+    SearchLimits limits;                     // per move; maxSeconds is the thinking time
+    bool ponder;                             // think on the opponent's time?
+
+    std::atomic<bool> cancel{false};         // stops the background search
+    std::future<SearchResult> pondering{};   // valid() while a ponder search runs
+    MnkState ponderState{};                  // position being pondered
+    std::chrono::steady_clock::time_point ponderStart{};
+    EngineStats stats{};
+};
+
+std::shared_ptr<Engine> makeEngine(const MnkRules& rules, std::shared_ptr<TranspositionTable> table,
+                                   SearchLimits limits, bool ponder);
+
+// Our move in 'state' (the opponent has just moved into it). Uses the
+// pondered search on a hit, then starts pondering on the expected reply.
+SearchResult engineMove(Engine& engine, const MnkState& state);
+
+// Cancel any background search and wait for it to stop
+void engineStopPondering(Engine& engine);
+
+// The engine as a strategy (for playMnkGame)
+MnkStrategy engineStrategy(std::shared_ptr<Engine> engine);
+
+#endif // TICTACTOE_ENGINE_H
@@ -0,0 +1,36 @@
+#include "eval.h"
+#include <algorithm>
+#include <numeric>
+
+PatternEval makePatternEval(const MnkRules& rules) {
+    // Weight of a one-sided line with n pieces: 0, 1, 4, 16, ... (capped so
+    // that long lines on big boards cannot overflow)
+    const auto weight = [](int n) { return n == 0 ? 0 : 1 << std::min(2 * (n - 1), 20); };
+    PatternEval eval{rules.k, std::vector<int>(static_cast<std::size_t>((rules.k + 1) * (rules.k + 1)), 0)};
+    for (int xs = 0; xs <= rules.k; ++xs) {
+        for (int os = 0; os <= rules.k; ++os) {
+            eval.lineScore[xs * (rules.k + 1) + os] =
+                os == 0 ? weight(xs) : xs == 0 ? -weight(os) : 0;
+        }
+    }
+    return eval;
+}
+
+int patternEvaluate(const MnkRules& rules, const PatternEval& eval, Bitboard x, Bitboard o) {
+    return std::accumulate(rules.lines.begin(), rules.lines.end(), 0, [&](int sum, Bitboard line) {
+        return sum + patternLineScore(eval, __builtin_popcountll(x & line), __builtin_popcountll(o & line));
+    });
+}
+
+int patternDelta(const MnkRules& rules, const PatternEval& eval, const MnkState& state, int cell) {
+    const int addX = state.toMove == Cell::X;
+    const int addO = 1 - addX;
+    int delta = 0;
+    for (int index : rules.linesThrough[cell]) {
+        const Bitboard line = rules.lines[index];
+        const int xs = __builtin_popcountll(state.x & line);
+        const int os = __builtin_popcountll(state.o & line);
+        delta += patternLineScore(eval, xs + addX, os + addO) - patternLineScore(eval, xs, os);
+    }
+    return delta;
+}
@@ -0,0 +1,51 @@
+#ifndef TICTACTOE_EVAL_H
+#define TICTACTOE_EVAL_H
+
+#include "mnk.h"
+#include <vector>
+
+// ============================================================================
+// PATTERN EVALUATION
+//
+// When the search runs out of depth it needs a guess at who is better. A
+// classic guess for k-in-a-row games looks at every winning window (line):
+//
+//   - a line holding pieces of BOTH players can never be won: worth 0
+//   - a line holding only X pieces is a threat for X, worth more the more
+//     pieces it has: 1, 4, 16, 64, ... for 1, 2, 3, 4, ... pieces
+//   - the same for O, negated
+//
+// The score of a line depends only on its two piece counts, so it is one
+// lookup into a (k + 1) x (k + 1) table: lineScore[xCount][oCount]. The
+// counts are two popcounts of the line mask ANDed with each bitboard.
+//
+// INCREMENTAL UPDATE: a move only changes the lines through its cell, so
+//   eval(child) = eval(parent) + sum over lines through the cell of
+//                 (score of the line after) - (score of the line before)
+// That is 4 to 20 lines, where a full evaluation visits every line on the
+// board (over 100 on 7x7 k=5). Undoing a move needs no work at all: the
+// parent's evaluation is still sitting in the parent's variable.
+//
+// Scores are from X's point of view; the search negates them for O.
+// ============================================================================
+
+struct PatternEval {
+    int k;
+    std::vector<int> lineScore;   // [xCount * (k + 1) + oCount]
+};
+
+// Lookup table for the rules' line length
+PatternEval makePatternEval(const MnkRules& rules);
+
+// Score of one line from its piece counts
+inline int patternLineScore(const PatternEval& eval, int xCount, int oCount) {
+    return eval.lineScore[xCount * (eval.k + 1) + oCount];
+}
+
+// Full evaluation: every line on the board
+int patternEvaluate(const MnkRules& rules, const PatternEval& eval, Bitboard x, Bitboard o);
+
+// Change in evaluation when the side to move in 'state' plays 'cell'
+int patternDelta(const MnkRules& rules, const PatternEval& eval, const MnkState& state, int cell);
+
+#endif // TICTACTOE_EVAL_H
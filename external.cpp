@@ -0,0 +1,362 @@
+#include "external.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <queue>
+
+// ============================================================================
+// Position Records
+// ============================================================================
+
+std::uint64_t packPosition(const MnkRules& rules, Bitboard x, Bitboard o) {
+    return x | (o << rules.cells);
+}
+
+std::pair<Bitboard, Bitboard> unpackPosition(const MnkRules& rules, std::uint64_t code) {
+    return {code & rules.fullMask, (code >> rules.cells) & rules.fullMask};
+}
+
+// Helper: record for the canonical form of a position
+std::uint64_t canonicalCode(const MnkRules& rules, Bitboard x, Bitboard o) {
+    const std::pair<Bitboard, Bitboard> canonical = canonicalBitboards(rules, x, o);
+    return packPosition(rules, canonical.first, canonical.second);
+}
+
+// ============================================================================
+// Sequential Record Files
+//
+// Files of raw 64-bit records, always read and written front to back through
+// a large buffer - the only access pattern disks are fast at.
+// ============================================================================
+
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+using FilePtr = std::unique_ptr<std::FILE, FileCloser>;
+
+// Records read per fread() call (1MB)
+constexpr std::size_t streamRecords = std::size_t{1} << 17;
+
+struct RecordReader {
+    FilePtr file;
+    std::string path;
+    std::vector<std::uint64_t> buffer;
+    std::size_t pos = 0;
+    std::size_t count = 0;
+    ExternalSolveReport* report;
+};
+
+struct RecordWriter {
+    FilePtr file;
+    std::string path;
+    std::vector<std::uint64_t> buffer;
+    std::uint64_t written = 0;
+    ExternalSolveReport* report;
+};
+
+// Helper: remember the first file error; later ones are usually its echoes
+void fileError(ExternalSolveReport& report, const std::string& message) {
+    if (report.error.empty()) report.error = message;
+}
+
+// Helper: refill the buffer if it is used up; false at end of file (or on
+// a read error, which is recorded in the report)
+bool readerHasRecord(RecordReader& reader) {
+    if (reader.pos == reader.count && reader.file) {
+        reader.count = std::fread(reader.buffer.data(), sizeof(std::uint64_t), reader.buffer.size(),
+                                  reader.file.get());
+        reader.pos = 0;
+        reader.report->bytesRead += reader.count * sizeof(std::uint64_t);
+        if (std::ferror(reader.file.get())) {
+            fileError(*reader.report, "could not read " + reader.path);
+            reader.count = 0;
+        }
+        if (reader.count == 0) reader.file.reset();
+    }
+    return reader.pos < reader.count;
+}
+
+RecordReader openReader(const std::string& path, std::size_t bufferRecords, ExternalSolveReport& report) {
+    FilePtr file(std::fopen(path.c_str(), "rb"));
+    if (!file) fileError(report, "could not open " + path);
+    return RecordReader{std::move(file), path, std::vector<std::uint64_t>(std::max<std::size_t>(bufferRecords, 1)),
+                        0, 0, &report};
+}
+
+RecordWriter openWriter(const std::string& path, ExternalSolveReport& report) {
+    FilePtr file(std::fopen(path.c_str(), "wb"));
+    if (!file) fileError(report, "could not create " + path);
+    return RecordWriter{std::move(file), path, {}, 0, &report};
+}
+
+// Records written to a writer whose file failed are dropped; the error is
+// already in the report
+void flushWriter(RecordWriter& writer) {
+    if (writer.file) {
+        const std::size_t done = std::fwrite(writer.buffer.data(), sizeof(std::uint64_t), writer.buffer.size(),
+                                             writer.file.get());
+        writer.report->bytesWritten += done * sizeof(std::uint64_t);
+        if (done != writer.buffer.size()) {
+            fileError(*writer.report, "could not write " + writer.path + " (disk full?)");
+            writer.file.reset();
+        }
+    }
+    writer.buffer.clear();
+}
+
+void writeRecord(RecordWriter& writer, std::uint64_t record) {
+    writer.buffer.push_back(record);
+    ++writer.written;
+    if (writer.buffer.size() == streamRecords) flushWriter(writer);
+}
+
+// fclose flushes the C library's own buffer, so it can fail too
+void closeWriter(RecordWriter& writer) {
+    flushWriter(writer);
+    if (writer.file && std::fclose(writer.file.release()) != 0) {
+        fileError(*writer.report, "could not write " + writer.path + " (disk full?)");
+    }
+}
+
+// ============================================================================
+// External Sort
+//
+// Records are collected in a buffer of at most config.memoryBytes. A full
+// buffer is sorted, deduplicated and written out as a run. At the end the
+// runs are merged with a priority queue holding the smallest unread record
+// of every run. If nothing was ever spilled, the buffer is used directly.
+// ============================================================================
+
+struct RunBuilder {
+    std::string prefix;                  // run files are prefix-0.run, prefix-1.run, ...
+    std::size_t capacity;                // records
+    std::vector<std::uint64_t> buffer;
+    std::vector<std::string> runs;
+    ExternalSolveReport* report;
+};
+
+// Helper: a builder whose buffer is allocated once, at its full size. Left
+// to grow by doubling, it would briefly hold old and new allocation at once
+// and overshoot the budget. At least one record, however small the budget.
+RunBuilder makeRunBuilder(std::string prefix, std::size_t memoryBytes, ExternalSolveReport& report) {
+    RunBuilder builder{std::move(prefix), std::max<std::size_t>(memoryBytes / sizeof(std::uint64_t), 1), {}, {}, &report};
+    builder.buffer.reserve(builder.capacity);
+    return builder;
+}
+
+void sortUnique(std::vector<std::uint64_t>& records) {
+    std::sort(records.begin(), records.end());
+    records.erase(std::unique(records.begin(), records.end()), records.end());
+}
+
+void spillRun(RunBuilder& builder) {
+    sortUnique(builder.buffer);
+    const std::string path = builder.prefix + "-" + std::to_string(builder.runs.size()) + ".run";
+    RecordWriter writer = openWriter(path, *builder.report);
+    std::for_each(builder.buffer.begin(), builder.buffer.end(),
+        [&](std::uint64_t record) { writeRecord(writer, record); });
+    closeWriter(writer);
+    builder.runs.push_back(path);
+    builder.buffer.clear();
+    builder.buffer.reserve(builder.capacity);   // clear() keeps it; make sure
+}
+
+void addRecord(RunBuilder& builder, std::uint64_t record) {
+    builder.buffer.push_back(record);
+    if (builder.buffer.size() == builder.capacity) spillRun(builder);
+}
+
+// Visit every distinct record in increasing order, then delete the runs.
+// Returns the number of runs that were written.
+template <typename Visit>
+std::size_t mergeRuns(RunBuilder& builder, std::size_t memoryBytes, Visit visit) {
+    if (builder.runs.empty()) {
+        sortUnique(builder.buffer);
+        std::for_each(builder.buffer.begin(), builder.buffer.end(), visit);
+        std::vector<std::uint64_t>().swap(builder.buffer);
+        return 0;
+    }
+    if (!builder.buffer.empty()) spillRun(builder);
+    std::vector<std::uint64_t>().swap(builder.buffer);   // release the memory
+
+    // Share the memory budget between the run readers
+    const std::size_t perRun = std::min(streamRecords,
+        memoryBytes / sizeof(std::uint64_t) / (builder.runs.size() + 1));
+    std::vector<RecordReader> readers;
+    for (const std::string& run : builder.runs) {
+        readers.push_back(openReader(run, perRun, *builder.report));
+    }
+
+    // Min-heap of (record, run index)
+    using Head = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (std::size_t i = 0; i < readers.size(); ++i) {
+        if (readerHasRecord(readers[i])) heads.push({readers[i].buffer[readers[i].pos++], i});
+    }
+    bool first = true;
+    std::uint64_t previous = 0;
+    while (!heads.empty()) {
+        const Head head = heads.top();
+        heads.pop();
+        if (first || head.first != previous) visit(head.first);
+        first = false;
+        previous = head.first;
+        RecordReader& reader = readers[head.second];
+        if (readerHasRecord(reader)) heads.push({reader.buffer[reader.pos++], head.second});
+    }
+
+    std::for_each(builder.runs.begin(), builder.runs.end(),
+        [](const std::string& run) { std::remove(run.c_str()); });
+    const std::size_t runs = builder.runs.size();
+    builder.runs.clear();
+    return runs;
+}
+
+// ============================================================================
+// The Solver
+// ============================================================================
+
+// Helper: does 'pieces' contain a complete line?
+bool containsLine(const MnkRules& rules, Bitboard pieces) {
+    return std::any_of(rules.lines.begin(), rules.lines.end(),
+        [&](Bitboard line) { return (pieces & line) == line; });
+}
+
+// Helper: has the game already ended in this position (not counting a draw)?
+bool someoneWon(const MnkRules& rules, Bitboard x, Bitboard o) {
+    return containsLine(rules, x) || containsLine(rules, o);
+}
+
+std::string layerPath(const ExternalSolverConfig& config, int layer, const char* kind) {
+    return config.workDir + "/layer-" + std::to_string(layer) + "." + kind;
+}
+
+// Forward pass: write layer-N.positions for every reachable piece count.
+// Returns the last non-empty layer (or the last one attempted, after a file
+// error).
+int enumerateLayers(const MnkRules& rules, const ExternalSolverConfig& config, ExternalSolveReport& report) {
+    RecordWriter first = openWriter(layerPath(config, 0, "positions"), report);
+    writeRecord(first, packPosition(rules, 0, 0));
+    closeWriter(first);
+    report.layers.push_back(ExternalLayerReport{1, 0});
+
+    int n = 0;
+    for (; n < rules.cells && report.error.empty(); ++n) {
+        RunBuilder builder = makeRunBuilder(config.workDir + "/forward", config.memoryBytes, report);
+        RecordReader reader = openReader(layerPath(config, n, "positions"), streamRecords, report);
+        for (; readerHasRecord(reader); ++reader.pos) {
+            const auto [x, o] = unpackPosition(rules, reader.buffer[reader.pos]);
+            if (someoneWon(rules, x, o)) continue;
+            const bool xToMove = __builtin_popcountll(x) == __builtin_popcountll(o);
+            for (Bitboard empty = rules.fullMask & ~(x | o); empty != 0; empty &= empty - 1) {
+                const Bitboard bit = empty & (~empty + 1);
+                addRecord(builder, xToMove ? canonicalCode(rules, x | bit, o) : canonicalCode(rules, x, o | bit));
+            }
+        }
+
+        RecordWriter writer = openWriter(layerPath(config, n + 1, "positions"), report);
+        const std::size_t runs = mergeRuns(builder, config.memoryBytes,
+            [&](std::uint64_t code) { writeRecord(writer, code); });
+        closeWriter(writer);
+        report.layers.push_back(ExternalLayerReport{writer.written, runs});
+        if (writer.written == 0) {
+            std::remove(layerPath(config, n + 1, "positions").c_str());
+            report.layers.pop_back();
+            break;
+        }
+    }
+    return std::min(n, rules.cells);
+}
+
+// Backward pass for one layer: combine layer-N.positions with the values in
+// layer-(N+1).solved into layer-N.solved
+void solveLayer(const MnkRules& rules, const ExternalSolverConfig& config, int n, int lastLayer,
+                ExternalSolveReport& report) {
+    // Every (parent, child value) edge, sorted by parent
+    RunBuilder edges = makeRunBuilder(config.workDir + "/backward", config.memoryBytes, report);
+    if (n < lastLayer) {
+        RecordReader children = openReader(layerPath(config, n + 1, "solved"), streamRecords, report);
+        for (; readerHasRecord(children); ++children.pos) {
+            const std::uint64_t record = children.buffer[children.pos];
+            const auto [x, o] = unpackPosition(rules, record >> 8);
+            // The side NOT to move made the last move; take back each of its pieces
+            const bool xMovedLast = __builtin_popcountll(x) > __builtin_popcountll(o);
+            for (Bitboard last = xMovedLast ? x : o; last != 0; last &= last - 1) {
+                const Bitboard bit = last & (~last + 1);
+                const std::uint64_t parent = xMovedLast ? canonicalCode(rules, x & ~bit, o)
+                                                        : canonicalCode(rules, x, o & ~bit);
+                addRecord(edges, parent << 8 | (record & 0xFF));
+            }
+        }
+    }
+
+    // Merge join: positions and edges both arrive sorted by position
+    RecordReader positions = openReader(layerPath(config, n, "positions"), streamRecords, report);
+    RecordWriter solved = openWriter(layerPath(config, n, "solved"), report);
+    bool canDraw = false;
+    int fastestWin = maxCells;
+    int slowestLoss = -1;
+    std::uint64_t current = 0;
+
+    // Helper: value of 'current' from its aggregated children, then reset
+    const auto finishPosition = [&]() {
+        const auto [x, o] = unpackPosition(rules, current);
+        const PositionValue value = someoneWon(rules, x, o) ? PositionValue{Outcome::Loss, 0}
+            : fastestWin < maxCells ? PositionValue{Outcome::Win, fastestWin}
+            : (canDraw || slowestLoss < 0) ? PositionValue{Outcome::Draw, 0}
+            : PositionValue{Outcome::Loss, slowestLoss};
+        writeRecord(solved, current << 8 | packValue(value));
+        if (n == 0) report.root = value;
+        canDraw = false;
+        fastestWin = maxCells;
+        slowestLoss = -1;
+    };
+
+    bool havePosition = readerHasRecord(positions);
+    current = havePosition ? positions.buffer[positions.pos] : 0;
+    const auto advancePosition = [&]() {
+        finishPosition();
+        ++positions.pos;
+        havePosition = readerHasRecord(positions);
+        current = havePosition ? positions.buffer[positions.pos] : 0;
+    };
+
+    mergeRuns(edges, config.memoryBytes, [&](std::uint64_t edge) {
+        const std::uint64_t parent = edge >> 8;
+        while (havePosition && current < parent) advancePosition();
+        // Edges to parents that were never reached (or only through a
+        // finished game) have no matching position and are skipped
+        if (havePosition && current == parent) {
+            const PositionValue child = unpackValue(static_cast<std::uint8_t>(edge & 0xFF));
+            if (child.outcome == Outcome::Loss) fastestWin = std::min(fastestWin, child.plies + 1);
+            if (child.outcome == Outcome::Draw) canDraw = true;
+            if (child.outcome == Outcome::Win) slowestLoss = std::max(slowestLoss, child.plies + 1);
+        }
+    });
+    while (havePosition) advancePosition();
+    closeWriter(solved);
+
+    if (!config.keepFiles) {
+        std::remove(layerPath(config, n, "positions").c_str());
+        if (n < lastLayer) std::remove(layerPath(config, n + 1, "solved").c_str());
+    }
+}
+
+ExternalSolveReport solveExternal(const MnkRules& rules, const ExternalSolverConfig& config) {
+    ExternalSolveReport report;
+    const int lastLayer = enumerateLayers(rules, config, report);
+    for (int n = lastLayer; n >= 0 && report.error.empty(); --n) {
+        solveLayer(rules, config, n, lastLayer, report);
+    }
+    if (!report.error.empty()) {
+        // Whatever got written is incomplete: no value, and no files left behind
+        report.root = PositionValue{Outcome::Illegal, 0};
+        for (int n = 0; n <= lastLayer + 1 && !config.keepFiles; ++n) {
+            std::remove(layerPath(config, n, "positions").c_str());
+            std::remove(layerPath(config, n, "solved").c_str());
+        }
+        return report;
+    }
+    if (!config.keepFiles) std::remove(layerPath(config, 0, "solved").c_str());
+    return report;
+}
@@ -0,0 +1,72 @@
+#ifndef TICTACTOE_EXTERNAL_H
+#define TICTACTOE_EXTERNAL_H
+
+#include "mnk.h"
+#include "tablebase.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// EXTERNAL-MEMORY SOLVING
+//
+// The tablebase solver keeps one byte per position in RAM. That stops working
+// at about 20 cells: 5x5 has billions of reachable positions even after
+// symmetry reduction. This solver keeps the positions ON DISK and only ever
+// holds a bounded buffer in memory.
+//
+// Disks are fast when read or written front to back and very slow when
+// accessed at random, so every step is a SEQUENTIAL pass over sorted files:
+//
+// Forward pass (which positions exist?), for each piece count n:
+//   1. Stream layer n. Append the canonical form of every child to a memory
+//      buffer. When the buffer is full, sort it, drop duplicates, and write
+//      it out as a sorted "run" file.
+//   2. Merge all runs at once (a k-way merge), dropping duplicates
+//      -> layer n + 1, sorted.
+//
+// Backward pass (what are they worth?), for n = cells down to 0:
+//   1. Stream solved layer n + 1. For every position, undo each possible
+//      last move and emit the record (parent, child value). Sort these
+//      records by parent, the same way as above.
+//   2. Walk layer n and the sorted records side by side (a "merge join"):
+//      all the child values of a parent arrive together, so its value is
+//      decided in one step -> solved layer n.
+//
+// Records are 64-bit integers: a position packs into x | o << cells, which
+// leaves the top bits free for a value byte. That limits boards to 28 cells.
+// ============================================================================
+
+constexpr int maxExternalCells = 28;
+
+struct ExternalSolverConfig {
+    std::string workDir = ".";                  // where layer and run files go
+    std::size_t memoryBytes = std::size_t{2} << 30;   // cap on sort buffers (2GB)
+    bool keepFiles = false;                     // keep layer files afterwards
+};
+
+// Statistics for one piece-count layer
+struct ExternalLayerReport {
+    std::uint64_t positions = 0;   // distinct canonical positions
+    std::uint64_t runs = 0;        // sorted runs written while building it
+};
+
+struct ExternalSolveReport {
+    std::vector<ExternalLayerReport> layers;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t bytesRead = 0;
+    PositionValue root{Outcome::Illegal, 0};   // value of the empty board
+    std::string error;                          // empty unless a file could not be opened, written or read
+};
+
+// Solve a board of up to 28 cells, streaming through files in config.workDir.
+// Solved layers are named layer-N.solved (kept only with keepFiles). The
+// first file error stops the solve and is reported in 'error'; the root is
+// then left Illegal.
+ExternalSolveReport solveExternal(const MnkRules& rules, const ExternalSolverConfig& config);
+
+// Pack a canonical position into one record, and back
+std::uint64_t packPosition(const MnkRules& rules, Bitboard x, Bitboard o);
+std::pair<Bitboard, Bitboard> unpackPosition(const MnkRules& rules, std::uint64_t code);
+
+#endif // TICTACTOE_EXTERNAL_H
@@ -0,0 +1,291 @@
+#include "featurize.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICTACTOE_FEATURES_AVX512 1
+#define TICTACTOE_AVX512_TARGET __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx512vbmi,avx512vpopcntdq")))
+#endif
+
+FeatureTables makeFeatureTables(const MnkRules& rules) {
+    FeatureTables tables;
+    tables.rules = rules;
+    tables.lineCount = static_cast<int>(rules.lines.size());
+    tables.lines = rules.lines;
+    tables.lines.resize((rules.lines.size() + 7) / 8 * 8, 0);
+    const std::size_t symmetries = rules.symmetries.size();
+    tables.sourceBytes.resize(symmetries * maxCells);
+    tables.sourceCells.resize(symmetries * maxCells);
+    for (std::size_t s = 0; s < symmetries; ++s) {
+        std::int32_t* source = &tables.sourceCells[s * maxCells];
+        for (int d = 0; d < maxCells; ++d) source[d] = d;
+        for (int c = 0; c < rules.cells; ++c) source[rules.symmetries[s][static_cast<std::size_t>(c)]] = c;
+        for (int d = 0; d < maxCells; ++d) tables.sourceBytes[s * maxCells + static_cast<std::size_t>(d)] = static_cast<std::uint8_t>(source[d]);
+    }
+    return tables;
+}
+
+// ============================================================================
+// Scalar Kernels
+//
+// Bit tricks, but one cell or one line at a time: the reference the
+// AVX-512 kernel is checked against.
+// ============================================================================
+
+// Helper: own counts into counts[0..lineCount), opponent counts after them,
+// and both threat masks; 'counts' may be null
+void lineFeaturesScalar(const FeatureTables& tables, const MnkState& state, float* counts, Bitboard* threats) {
+    const Bitboard own = ownPieces(state);
+    const Bitboard opp = opponentPieces(state);
+    const int nearlyFull = tables.rules.k - 1;
+    Bitboard ownThreats = 0;
+    Bitboard oppThreats = 0;
+    for (int l = 0; l < tables.lineCount; ++l) {
+        const Bitboard line = tables.lines[static_cast<std::size_t>(l)];
+        const int ours = __builtin_popcountll(line & own);
+        const int theirs = __builtin_popcountll(line & opp);
+        if (ours == nearlyFull && theirs == 0) ownThreats |= line;
+        if (theirs == nearlyFull && ours == 0) oppThreats |= line;
+        if (counts != nullptr) {
+            counts[l] = static_cast<float>(ours);
+            counts[tables.lineCount + l] = static_cast<float>(theirs);
+        }
+    }
+    const Bitboard empty = emptyCells(tables.rules, state);
+    threats[0] = ownThreats & empty;
+    threats[1] = oppThreats & empty;
+}
+
+// Helper: one bitboard as a plane of 0/1 floats
+void planeScalar(Bitboard bits, int cells, float* plane) {
+    for (int c = 0; c < cells; ++c) plane[c] = static_cast<float>((bits >> c) & 1);
+}
+
+MnkState transformScalar(const FeatureTables& tables, const MnkState& state, int symmetry) {
+    const Bitboard x = transformBitboard(tables.rules, state.x, symmetry);
+    const Bitboard o = transformBitboard(tables.rules, state.o, symmetry);
+    return MnkState{x, o, computeKey(x, o), state.moves, state.toMove, state.winner};
+}
+
+void transformCellsScalar(const FeatureTables& tables, const float* in, int symmetry, float* out) {
+    const std::vector<int>& image = tables.rules.symmetries[static_cast<std::size_t>(symmetry)];
+    for (int c = 0; c < tables.rules.cells; ++c) out[image[static_cast<std::size_t>(c)]] = in[c];
+}
+
+// ============================================================================
+// AVX-512 Kernels
+// ============================================================================
+
+#ifdef TICTACTOE_FEATURES_AVX512
+// Helper: lanes 0 .. n-1 of a 16-lane mask, n capped at 16
+inline __mmask16 firstLanes(int n) {
+    return n >= 16 ? __mmask16{0xFFFF} : static_cast<__mmask16>((1u << n) - 1);
+}
+
+// Helper: the 8 lanes folded together with OR or XOR. Through memory: the
+// in-register shuffles trip false "uninitialized" warnings in GCC 12.
+template <bool Xor>
+TICTACTOE_AVX512_TARGET
+std::uint64_t foldLanes(__m512i v) {
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, v);
+    std::uint64_t folded = 0;
+    for (const std::uint64_t lane : lanes) folded = Xor ? folded ^ lane : folded | lane;
+    return folded;
+}
+
+// Helper: lineFeaturesScalar, 8 lines per step
+TICTACTOE_AVX512_TARGET
+void lineFeaturesAvx512(const FeatureTables& tables, const MnkState& state, float* counts, Bitboard* threats) {
+    const __m512i own = _mm512_set1_epi64(static_cast<long long>(ownPieces(state)));
+    const __m512i opp = _mm512_set1_epi64(static_cast<long long>(opponentPieces(state)));
+    const __m512i nearlyFull = _mm512_set1_epi64(tables.rules.k - 1);
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i ownThreats = zero;
+    __m512i oppThreats = zero;
+    for (int l = 0; l < static_cast<int>(tables.lines.size()); l += 8) {
+        const __m512i lines = _mm512_loadu_si512(&tables.lines[static_cast<std::size_t>(l)]);
+        const __m512i ours = _mm512_popcnt_epi64(_mm512_and_si512(lines, own));
+        const __m512i theirs = _mm512_popcnt_epi64(_mm512_and_si512(lines, opp));
+        const __mmask8 ownLines = _mm512_cmpeq_epi64_mask(ours, nearlyFull) & _mm512_cmpeq_epi64_mask(theirs, zero);
+        const __mmask8 oppLines = _mm512_cmpeq_epi64_mask(theirs, nearlyFull) & _mm512_cmpeq_epi64_mask(ours, zero);
+        ownThreats = _mm512_mask_or_epi64(ownThreats, ownLines, ownThreats, lines);
+        oppThreats = _mm512_mask_or_epi64(oppThreats, oppLines, oppThreats, lines);
+        if (counts != nullptr) {
+            // The padding lines past lineCount are not stored
+            const auto real = static_cast<__mmask8>(firstLanes(tables.lineCount - l));
+            _mm256_mask_storeu_ps(counts + l, real, _mm512_cvtepi64_ps(ours));
+            _mm256_mask_storeu_ps(counts + tables.lineCount + l, real, _mm512_cvtepi64_ps(theirs));
+        }
+    }
+    const Bitboard empty = emptyCells(tables.rules, state);
+    threats[0] = foldLanes<false>(ownThreats) & empty;
+    threats[1] = foldLanes<false>(oppThreats) & empty;
+}
+
+// Helper: a plane is the bitboard used as a mask, 16 cells per store
+TICTACTOE_AVX512_TARGET
+void planeAvx512(Bitboard bits, int cells, float* plane) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+    for (int c = 0; c < cells; c += 16) {
+        _mm512_mask_storeu_ps(plane + c, firstLanes(cells - c), _mm512_maskz_mov_ps(static_cast<__mmask16>(bits >> c), one));
+    }
+}
+
+// Helper: the images of 'state' under 'symmetries' symmetries, starting at
+// 'first', into images[0 ..). The byte board is built once and shuffled
+// once per symmetry.
+TICTACTOE_AVX512_TARGET
+void imagesAvx512(const FeatureTables& tables, const MnkState& state, int first, int symmetries, MnkState* images) {
+    const __m512i xs = _mm512_set1_epi8(1);
+    const __m512i os = _mm512_set1_epi8(2);
+    const __m512i board = _mm512_or_si512(_mm512_maskz_mov_epi8(state.x, xs), _mm512_maskz_mov_epi8(state.o, os));
+    for (int s = 0; s < symmetries; ++s) {
+        const __m512i source = _mm512_loadu_si512(&tables.sourceBytes[static_cast<std::size_t>(first + s) * maxCells]);
+        // The one shuffle (the zero-masking form, keeping every byte: the
+        // plain form trips a false "uninitialized" warning in GCC 12)
+        const __m512i moved = _mm512_maskz_permutexvar_epi8(~__mmask64{0}, source, board);
+        const Bitboard x = _mm512_test_epi8_mask(moved, xs);
+        const Bitboard o = _mm512_test_epi8_mask(moved, os);
+
+        // Zobrist key: XOR in the keys of 8 cells at a time, masked by the pieces
+        __m512i key = _mm512_setzero_si512();
+        for (int c = 0; c < tables.rules.cells; c += 8) {
+            key = _mm512_mask_xor_epi64(key, static_cast<__mmask8>(x >> c), key, _mm512_loadu_si512(&zobristKeys[0][static_cast<std::size_t>(c)]));
+            key = _mm512_mask_xor_epi64(key, static_cast<__mmask8>(o >> c), key, _mm512_loadu_si512(&zobristKeys[1][static_cast<std::size_t>(c)]));
+        }
+        images[s] = MnkState{x, o, foldLanes<true>(key), state.moves, state.toMove, state.winner};
+    }
+}
+
+// Helper: 64 floats are four registers. Each group of 16 outputs picks from
+// all four: a two-register permute for each half, then bit 5 of the source
+// cell chooses between them.
+TICTACTOE_AVX512_TARGET
+void transformCellsAvx512(const FeatureTables& tables, const float* in, int symmetry, float* out) {
+    const int cells = tables.rules.cells;
+    __m512 values[4];
+    for (int q = 0; q < 4; ++q) values[q] = _mm512_maskz_loadu_ps(firstLanes(std::max(cells - 16 * q, 0)), in + 16 * q);
+    const __m512i upperHalf = _mm512_set1_epi32(32);
+    const std::int32_t* sources = &tables.sourceCells[static_cast<std::size_t>(symmetry) * maxCells];
+    for (int c = 0; c < cells; c += 16) {
+        const __m512i source = _mm512_loadu_si512(sources + c);
+        const __m512 low = _mm512_permutex2var_ps(values[0], source, values[1]);
+        const __m512 high = _mm512_permutex2var_ps(values[2], source, values[3]);
+        _mm512_mask_storeu_ps(out + c, firstLanes(cells - c),
+                              _mm512_mask_blend_ps(_mm512_test_epi32_mask(source, upperHalf), low, high));
+    }
+}
+#endif
+
+bool featureAvx512Available() {
+#ifdef TICTACTOE_FEATURES_AVX512
+    static const bool available = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                                  __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl") &&
+                                  __builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512vpopcntdq");
+    return available;
+#else
+    return false;
+#endif
+}
+
+// Helper: should 'kernel' run the AVX-512 code here?
+bool useAvx512(FeatureKernel kernel) {
+    return kernel != FeatureKernel::Scalar && featureAvx512Available();
+}
+
+// ============================================================================
+// Batches
+// ============================================================================
+
+void extractPlanes(const FeatureTables& tables, const MnkState* states, int count, float* planes, FeatureKernel kernel) {
+    const int cells = tables.rules.cells;
+    const bool avx512 = useAvx512(kernel);
+    for (int i = 0; i < count; ++i) {
+        const MnkState& state = states[i];
+        Bitboard bits[featurePlanes] = {ownPieces(state), opponentPieces(state), emptyCells(tables.rules, state)};
+        float* out = planes + static_cast<std::size_t>(i) * featurePlanes * static_cast<std::size_t>(cells);
+#ifdef TICTACTOE_FEATURES_AVX512
+        if (avx512) {
+            lineFeaturesAvx512(tables, state, nullptr, &bits[3]);
+            for (int p = 0; p < featurePlanes; ++p) planeAvx512(bits[p], cells, out + p * cells);
+            continue;
+        }
+#endif
+        lineFeaturesScalar(tables, state, nullptr, &bits[3]);
+        for (int p = 0; p < featurePlanes; ++p) planeScalar(bits[p], cells, out + p * cells);
+    }
+    (void)avx512;
+}
+
+void extractLineCounts(const FeatureTables& tables, const MnkState* states, int count, float* counts, FeatureKernel kernel) {
+    const bool avx512 = useAvx512(kernel);
+    for (int i = 0; i < count; ++i) {
+        float* out = counts + static_cast<std::size_t>(i) * 2 * static_cast<std::size_t>(tables.lineCount);
+        Bitboard threats[2];
+#ifdef TICTACTOE_FEATURES_AVX512
+        if (avx512) {
+            lineFeaturesAvx512(tables, states[i], out, threats);
+            continue;
+        }
+#endif
+        lineFeaturesScalar(tables, states[i], out, threats);
+    }
+    (void)avx512;
+}
+
+void extractThreats(const FeatureTables& tables, const MnkState* states, int count, Bitboard* threats, FeatureKernel kernel) {
+    const bool avx512 = useAvx512(kernel);
+    for (int i = 0; i < count; ++i) {
+#ifdef TICTACTOE_FEATURES_AVX512
+        if (avx512) {
+            lineFeaturesAvx512(tables, states[i], nullptr, threats + 2 * i);
+            continue;
+        }
+#endif
+        lineFeaturesScalar(tables, states[i], nullptr, threats + 2 * i);
+    }
+    (void)avx512;
+}
+
+MnkState featureTransform(const FeatureTables& tables, const MnkState& state, int symmetry, FeatureKernel kernel) {
+#ifdef TICTACTOE_FEATURES_AVX512
+    if (useAvx512(kernel)) {
+        MnkState image;
+        imagesAvx512(tables, state, symmetry, 1, &image);
+        return image;
+    }
+#else
+    (void)kernel;
+#endif
+    return transformScalar(tables, state, symmetry);
+}
+
+void featureTransformCells(const FeatureTables& tables, const float* in, int symmetry, float* out, FeatureKernel kernel) {
+#ifdef TICTACTOE_FEATURES_AVX512
+    if (useAvx512(kernel)) {
+        transformCellsAvx512(tables, in, symmetry, out);
+        return;
+    }
+#else
+    (void)kernel;
+#endif
+    transformCellsScalar(tables, in, symmetry, out);
+}
+
+void symmetryImages(const FeatureTables& tables, const MnkState* states, int count, MnkState* images, FeatureKernel kernel) {
+    const int symmetries = static_cast<int>(tables.rules.symmetries.size());
+    const bool avx512 = useAvx512(kernel);
+    for (int i = 0; i < count; ++i) {
+        MnkState* out = images + static_cast<std::size_t>(i) * static_cast<std::size_t>(symmetries);
+        out[0] = states[i];
+#ifdef TICTACTOE_FEATURES_AVX512
+        if (avx512) {
+            imagesAvx512(tables, states[i], 1, symmetries - 1, out + 1);
+            continue;
+        }
+#endif
+        for (int s = 1; s < symmetries; ++s) out[s] = transformScalar(tables, states[i], s);
+    }
+    (void)avx512;
+}
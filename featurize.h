@@ -0,0 +1,96 @@
+#ifndef TICTACTOE_FEATURIZE_H
+#define TICTACTOE_FEATURIZE_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// FEATURE TENSORS
+//
+// Learning code wants a position as numbers in a fixed layout, not as
+// bitboards. For a batch of positions this module writes, all from the
+// point of view of the side to move:
+//
+//   planes   featurePlanes floats per cell, 0 or 1:
+//              0  own pieces          3  own threats
+//              1  opponent pieces     4  opponent threats
+//              2  empty cells
+//            A THREAT is an empty cell that completes a line: the line
+//            holds k - 1 pieces of one side and none of the other.
+//   counts   per line, how many of its k cells are ours and how many are
+//            the opponent's (all lines' own counts, then all opponent counts)
+//   images   the position under every symmetry of the board, for
+//            augmenting a data set eightfold (see mnk.h)
+//
+// Going cell by cell - "what is on cell c?" for every cell of every board -
+// is the slow way. Here a whole board is handled at once, and with
+// AVX-512 a 64-cell bitboard is exactly one MASK REGISTER:
+//
+//   planes    a mask selects which of 16 lanes get 1.0f: 16 cells of a
+//             plane per instruction, straight from the bitboard
+//   counts    8 line masks per register: AND with the pieces, popcount
+//             each 64-bit lane (VPOPCNTQ), compare with k - 1 for threats
+//   images    the board as 64 BYTES, one per cell (1 = X, 2 = O); a
+//             symmetry is a fixed permutation of those bytes, so the whole
+//             transform is ONE byte shuffle (VPERMB) with a precomputed
+//             index vector. Testing the shuffled bytes gives the new
+//             bitboards, and the Zobrist key is 16 masked XORs.
+//
+// AVX2 has no shuffle that crosses 16-byte lanes, let alone one over 64
+// bytes, so the SIMD kernel needs AVX-512 (F, BW, DQ, VL, VBMI, VPOPCNTDQ).
+// Like the other SIMD code here it is compiled with a target attribute and
+// picked at run time; the scalar kernel gives exactly the same results.
+// ============================================================================
+
+constexpr int featurePlanes = 5;
+
+enum class FeatureKernel { Best, Scalar, Avx512 };
+
+// Tables derived from the rules, laid out for the kernels. Build once with
+// makeFeatureTables and pass around by const reference.
+struct FeatureTables {
+    MnkRules rules;
+    int lineCount;                              // rules.lines.size()
+    std::vector<Bitboard> lines;                // rules.lines, zero-padded to a multiple of 8
+    // Per symmetry, 64 entries: the source cell of each destination cell
+    // (the inverse of rules.symmetries[s]); cells off the board map to
+    // themselves. As bytes for the shuffle, as int32 for moving floats.
+    std::vector<std::uint8_t> sourceBytes;      // [symmetry][64]
+    std::vector<std::int32_t> sourceCells;      // [symmetry][64]
+};
+
+FeatureTables makeFeatureTables(const MnkRules& rules);
+
+// Does this CPU run the AVX-512 kernel?
+bool featureAvx512Available();
+
+// Planes of states[0..count): planes[(i * featurePlanes + p) * cells + c]
+void extractPlanes(const FeatureTables& tables, const MnkState* states, int count, float* planes,
+                   FeatureKernel kernel = FeatureKernel::Best);
+
+// Line counts of states[0..count): counts[(i * 2 + side) * lineCount + line],
+// side 0 = the side to move
+void extractLineCounts(const FeatureTables& tables, const MnkState* states, int count, float* counts,
+                       FeatureKernel kernel = FeatureKernel::Best);
+
+// Threat masks of states[0..count): threats[2 * i] for the side to move,
+// threats[2 * i + 1] for the opponent
+void extractThreats(const FeatureTables& tables, const MnkState* states, int count, Bitboard* threats,
+                    FeatureKernel kernel = FeatureKernel::Best);
+
+// A state under symmetry s, key included (the winner, if any, carries over)
+MnkState featureTransform(const FeatureTables& tables, const MnkState& state, int symmetry,
+                          FeatureKernel kernel = FeatureKernel::Best);
+
+// Per-cell values (a policy, one plane) moved along with symmetry s:
+// out[image of c] = in[c]. 'in' and 'out' hold rules.cells floats and must
+// not overlap.
+void featureTransformCells(const FeatureTables& tables, const float* in, int symmetry, float* out,
+                           FeatureKernel kernel = FeatureKernel::Best);
+
+// Every state under every symmetry: images[i * symmetries + s]
+void symmetryImages(const FeatureTables& tables, const MnkState* states, int count, MnkState* images,
+                    FeatureKernel kernel = FeatureKernel::Best);
+
+#endif // TICTACTOE_FEATURIZE_H
@@ -0,0 +1,99 @@
+#include "inference.h"
+#include <algorithm>
+#include <stdexcept>
+
+// Helper: the server thread. Sleeps until there is a request, then until
+// the batch is full or its oldest request has waited long enough.
+void serveBatches(InferenceServer& server) {
+    const int batchSize = std::max(server.config.batchSize, 1);
+    std::vector<InferenceRequest> batch;
+    std::vector<MnkState> states;
+    std::vector<MlpOutput> outputs;
+    std::shared_ptr<const Mlp> mlp;
+
+    std::unique_lock<std::mutex> guard(server.lock);
+    for (;;) {
+        server.wake.wait(guard, [&]() { return server.done || !server.queue.empty(); });
+        if (server.queue.empty()) return;   // done, and nothing left over
+        const auto deadline = server.queue.front().arrival + server.config.maxWait;
+        server.wake.wait_until(guard, deadline, [&]() {
+            return server.done || server.queue.size() >= static_cast<std::size_t>(batchSize);
+        });
+
+        // Take the oldest batchSize requests; later ones wait for the next round
+        const std::size_t taken = std::min(server.queue.size(), static_cast<std::size_t>(batchSize));
+        batch.assign(std::make_move_iterator(server.queue.begin()),
+                     std::make_move_iterator(server.queue.begin() + static_cast<std::ptrdiff_t>(taken)));
+        server.queue.erase(server.queue.begin(), server.queue.begin() + static_cast<std::ptrdiff_t>(taken));
+        ++server.stats.batches;
+        server.stats.fullBatches += taken == static_cast<std::size_t>(batchSize);
+        mlp = server.mlp;
+        guard.unlock();
+
+        states.clear();
+        for (const InferenceRequest& request : batch) states.push_back(request.state);
+        outputs.resize(taken);
+        mlpForwardBatch(*mlp, states.data(), static_cast<int>(taken), outputs.data(), server.config.kernel);
+        for (std::size_t i = 0; i < taken; ++i) batch[i].result.set_value(outputs[i]);
+
+        guard.lock();
+    }
+}
+
+std::shared_ptr<InferenceServer> startInferenceServer(std::shared_ptr<const Mlp> mlp, BatchConfig config) {
+    const std::shared_ptr<InferenceServer> server(new InferenceServer, [](InferenceServer* server) {
+        stopInferenceServer(*server);
+        delete server;
+    });
+    server->mlp = std::move(mlp);
+    server->config = config;
+    server->thread = std::thread(serveBatches, std::ref(*server));
+    return server;
+}
+
+void stopInferenceServer(InferenceServer& server) {
+    {
+        const std::lock_guard<std::mutex> guard(server.lock);
+        server.done = true;
+    }
+    server.wake.notify_all();
+    if (server.thread.joinable()) server.thread.join();
+}
+
+std::future<MlpOutput> inferenceSubmit(InferenceServer& server, const MnkState& state) {
+    std::promise<MlpOutput> promise;
+    std::future<MlpOutput> future = promise.get_future();
+    bool notify;
+    {
+        const std::lock_guard<std::mutex> guard(server.lock);
+        // A stopped server would never answer: fail the request right away
+        if (server.done) {
+            promise.set_exception(std::make_exception_ptr(std::runtime_error("inference server stopped")));
+            return future;
+        }
+        server.queue.push_back(InferenceRequest{state, std::move(promise), std::chrono::steady_clock::now()});
+        ++server.stats.requests;
+        // The server needs waking for the first request (to start the clock)
+        // and for the one that fills the batch; otherwise let it sleep
+        notify = server.queue.size() == 1 ||
+                 server.queue.size() == static_cast<std::size_t>(std::max(server.config.batchSize, 1));
+    }
+    if (notify) server.wake.notify_one();
+    return future;
+}
+
+void inferenceSetNetwork(InferenceServer& server, std::shared_ptr<const Mlp> mlp) {
+    const std::lock_guard<std::mutex> guard(server.lock);
+    server.mlp = std::move(mlp);
+}
+
+InferenceStats inferenceStats(InferenceServer& server) {
+    const std::lock_guard<std::mutex> guard(server.lock);
+    return server.stats;
+}
+
+MnkStrategy inferenceStrategy(std::shared_ptr<InferenceServer> server) {
+    return [server](const MnkRules& rules, const MnkState& state) {
+        return mlpBestMove(rules, state, inferenceSubmit(*server, state).get());
+    };
+}
@@ -0,0 +1,86 @@
+#ifndef TICTACTOE_INFERENCE_H
+#define TICTACTOE_INFERENCE_H
+
+#include "mlp.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// BATCHED INFERENCE
+//
+// A single network evaluation wastes most of the kernel's speed (see the
+// BATCHES note in mlp.h), but a single game only ever has one position to
+// ask about. Many games running at once - or many search threads - have
+// many. The INFERENCE SERVER collects their requests:
+//
+//   client:  future = inferenceSubmit(server, position);  ...  future.get()
+//   server:  wait until batchSize requests are queued, or until the oldest
+//            has waited maxWait; evaluate them all in one mlpForwardBatch;
+//            hand each result to its client through its promise
+//
+// A std::promise is the writing end of a std::future: the server calls
+// promise.set_value(output) and the client blocked in future.get() wakes
+// up with it. The two knobs trade latency for throughput: a bigger batch
+// uses the kernel better, a longer wait fills more batches when clients
+// are few.
+// ============================================================================
+
+struct BatchConfig {
+    int batchSize = 64;                                 // evaluate at most this many at once
+    std::chrono::microseconds maxWait{200};             // how long a request may wait for company
+    MlpKernel kernel = MlpKernel::Best;
+};
+
+struct InferenceRequest {
+    MnkState state;
+    std::promise<MlpOutput> result;
+    std::chrono::steady_clock::time_point arrival;
+};
+
+struct InferenceStats {
+    std::uint64_t requests = 0;
+    std::uint64_t batches = 0;
+    std::uint64_t fullBatches = 0;   // sent because batchSize was reached
+};
+
+// Owns a thread and a queue that clients hold pointers into: create it with
+// startInferenceServer, whose pointer stops the thread when the last copy
+// goes away (a strategy, an unwinding exception, ...)
+struct InferenceServer {
+    BatchConfig config;
+    std::mutex lock;                        // guards the fields below
+    std::shared_ptr<const Mlp> mlp;         // each batch runs on the net current when it started
+    std::condition_variable wake;           // new request, or stopping
+    std::vector<InferenceRequest> queue;
+    bool done = false;
+    InferenceStats stats;
+    std::thread thread;
+};
+
+std::shared_ptr<InferenceServer> startInferenceServer(std::shared_ptr<const Mlp> mlp, BatchConfig config);
+
+// Evaluate what is still queued, then stop the server's thread. Safe to call
+// more than once.
+void stopInferenceServer(InferenceServer& server);
+
+// Queue a position; the future becomes ready once its batch has run. After
+// stopInferenceServer, get() throws std::runtime_error instead.
+std::future<MlpOutput> inferenceSubmit(InferenceServer& server, const MnkState& state);
+
+// Swap in another net (e.g. a newly trained one). Batches already running
+// finish on the old one, which lives as long as they hold it.
+void inferenceSetNetwork(InferenceServer& server, std::shared_ptr<const Mlp> mlp);
+
+// A snapshot of the counters
+InferenceStats inferenceStats(InferenceServer& server);
+
+// mlpStrategy through the server: many games on many threads share batches
+MnkStrategy inferenceStrategy(std::shared_ptr<InferenceServer> server);
+
+#endif // TICTACTOE_INFERENCE_H
@@ -1,4 +1,5 @@
 #include "tictactoe.h"
+#include "mnk.h"
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
@@ -98,6 +99,28 @@ int main() {
     std::cout << "Game 3 (First-Available vs First-Available):\n" << boardToString(game3.first);
     std::cout << "Winner: " << (game3.second == Cell::Empty ? "Draw" : std::string(1, cellToChar(game3.second))) << "\n\n";
 
+    // ========================================================================
+    // Demo 5: Generalized boards - same ideas, bigger games
+    // ========================================================================
+    std::cout << "DEMO 5: Generalized Boards (m,n,k-games)\n";
+    std::cout << "----------------------------------------\n\n";
+
+    // 4x4 board, 3 in a row wins. Each state carries its Zobrist key,
+    // updated with one XOR per move.
+    MnkRules rules4 = makeRules(4, 4, 3);
+    MnkState s0 = mnkEmpty();
+    std::optional<MnkState> s1 = mnkMakeMove(rules4, s0, 5);
+    std::optional<MnkState> s2 = mnkMakeMove(rules4, *s1, 6);
+    std::optional<MnkState> s3 = mnkMakeMove(rules4, *s2, 10);
+    std::cout << "4x4 board after three moves:\n" << stateToString(rules4, *s3) << "\n";
+    std::cout << "Zobrist key: " << std::hex << s3->key << std::dec
+              << " (recomputed: " << std::hex << computeKey(s3->x, s3->o) << std::dec << ")\n\n";
+
+    // Different move orders, same position, same key
+    std::optional<MnkState> t3 = mnkMakeMove(rules4, *mnkMakeMove(rules4, *mnkMakeMove(rules4, s0, 10), 6), 5);
+    std::cout << "Same position by another move order has the same key: "
+              << (t3->key == s3->key ? "yes" : "no") << "\n\n";
+
     // ========================================================================
     // Summary
     // ========================================================================
@@ -0,0 +1,228 @@
+#include "mcts.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+MctsTree makeMctsTree(const MnkState& root, std::uint64_t seed) {
+    return MctsTree{root, std::vector<MctsNode>(1), seed};
+}
+
+// ============================================================================
+// Playouts
+// ============================================================================
+
+// Helper: next pseudo-random number (splitmix64 of a counter)
+std::uint64_t nextRandom(MctsTree& tree) {
+    return splitMix64(tree.rng++);
+}
+
+// Helper: a uniformly random set bit of 'bits' (not 0)
+int randomCell(Bitboard bits, std::uint64_t random) {
+    for (int skip = static_cast<int>(random % static_cast<std::uint64_t>(__builtin_popcountll(bits))); skip > 0; --skip) {
+        bits &= bits - 1;
+    }
+    return __builtin_ctzll(bits);
+}
+
+// Helper: random moves to the end of the game; returns the final position
+MnkState simulate(const MnkRules& rules, MnkState state, MctsTree& tree) {
+    while (!mnkIsGameOver(rules, state)) {
+        state = mnkPlay(rules, state, randomCell(emptyCells(rules, state), nextRandom(tree)));
+    }
+    return state;
+}
+
+// Helper: give a node one child per empty cell, appended as one block
+void expand(const MnkRules& rules, MctsTree& tree, std::uint32_t index, const MnkState& state) {
+    const std::uint32_t first = static_cast<std::uint32_t>(tree.nodes.size());
+    for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+        MctsNode child;
+        child.move = static_cast<std::int16_t>(__builtin_ctzll(b));
+        tree.nodes.push_back(child);
+    }
+    // Only now take the reference: push_back may have moved the arena
+    MctsNode& node = tree.nodes[index];
+    node.firstChild = first;
+    node.childCount = static_cast<std::uint16_t>(tree.nodes.size() - first);
+}
+
+// Helper: a child's estimated value - plain win rate, or the RAVE blend.
+// A child never visited itself is judged on its AMAF statistics alone.
+double childValue(const MctsNode& child, const MctsConfig& config) {
+    const double visits = static_cast<double>(child.visits);
+    const double winRate = child.visits > 0 ? static_cast<double>(child.halfWins) / (2.0 * visits) : 0.0;
+    if (!config.rave || child.amafVisits == 0) return winRate;
+    const double amaf = static_cast<double>(child.amafHalfWins) / (2.0 * static_cast<double>(child.amafVisits));
+    const double beta = std::sqrt(config.raveEquivalence / (3.0 * visits + config.raveEquivalence));
+    return (1.0 - beta) * winRate + beta * amaf;
+}
+
+// Helper: the child with the highest UCT score. Children with no
+// information at all (no visits, and no AMAF data with RAVE) come first.
+std::uint32_t selectChild(const MctsTree& tree, std::uint32_t index, const MctsConfig& config) {
+    const MctsNode& node = tree.nodes[index];
+    const double logVisits = std::log(static_cast<double>(std::max<std::uint32_t>(node.visits, 1)));
+    std::uint32_t best = node.firstChild;
+    double bestScore = -1.0;
+    for (std::uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        const MctsNode& child = tree.nodes[i];
+        if (child.visits == 0 && (!config.rave || child.amafVisits == 0)) return i;
+        const double visits = static_cast<double>(std::max<std::uint32_t>(child.visits, 1));
+        const double score = childValue(child, config) + config.exploration * std::sqrt(logVisits / visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Helper: a playout's result for 'player', in half points
+std::uint64_t resultFor(Cell winner, Cell player) {
+    return winner == player ? 2 : winner == Cell::Empty ? 1 : 0;
+}
+
+// Helper: AMAF backup. At each node on the path, every child whose cell
+// the node's player to move took later in the playout shares the result.
+void updateAmaf(MctsTree& tree, const std::vector<std::uint32_t>& path,
+                const std::vector<MnkState>& states, const MnkState& final) {
+    for (std::size_t d = 0; d < path.size(); ++d) {
+        const MnkState& state = states[d];
+        const Bitboard later = state.toMove == Cell::X ? final.x & ~state.x : final.o & ~state.o;
+        const std::uint64_t result = resultFor(final.winner, state.toMove);
+        const MctsNode& node = tree.nodes[path[d]];
+        for (std::uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+            MctsNode& child = tree.nodes[i];
+            if ((later >> child.move) & 1) {
+                ++child.amafVisits;
+                child.amafHalfWins += result;
+            }
+        }
+    }
+}
+
+void mctsSearch(const MnkRules& rules, MctsTree& tree, const MctsConfig& config) {
+    std::vector<std::uint32_t> path;
+    std::vector<MnkState> states;   // position at each node of the path
+    for (int p = 0; p < config.playouts; ++p) {
+        // Selection
+        path.assign(1, 0);
+        states.assign(1, tree.root);
+        while (tree.nodes[path.back()].childCount > 0) {
+            path.push_back(selectChild(tree, path.back(), config));
+            states.push_back(mnkPlay(rules, states.back(), tree.nodes[path.back()].move));
+        }
+        // Expansion
+        if (!mnkIsGameOver(rules, states.back())) {
+            expand(rules, tree, path.back(), states.back());
+            path.push_back(selectChild(tree, path.back(), config));
+            states.push_back(mnkPlay(rules, states.back(), tree.nodes[path.back()].move));
+        }
+        // Simulation
+        const MnkState final = simulate(rules, states.back(), tree);
+        // Backup: each node's result is for the player who moved into it,
+        // the one to move in its parent
+        for (std::size_t d = 0; d < path.size(); ++d) {
+            MctsNode& node = tree.nodes[path[d]];
+            ++node.visits;
+            node.halfWins += resultFor(final.winner, nextPlayer(states[d].toMove));
+        }
+        if (config.rave) updateAmaf(tree, path, states, final);
+    }
+}
+
+int mctsBestMove(const MctsTree& tree) {
+    const MctsNode& root = tree.nodes[0];
+    const auto first = tree.nodes.begin() + root.firstChild;
+    return root.childCount == 0 ? -1
+        : std::max_element(first, first + root.childCount, [](const MctsNode& a, const MctsNode& b) {
+              return a.visits < b.visits;
+          })->move;
+}
+
+// ============================================================================
+// Subtree Reuse
+//
+// Keeping the subtree under node r is a small MARK-COMPACT garbage collection:
+//
+//   1. Mark     - walk the subtree from r and mark every node in it
+//   2. Forward  - give each marked node its new index: the number of marked
+//                 nodes before it. Kept nodes keep their relative order.
+//   3. Move     - copy each marked node to its new index, translating its
+//                 firstChild through the same table.
+//
+// A children block is entirely marked or entirely not, so blocks stay
+// contiguous. Children are always appended after their parent, so r comes
+// first and becomes index 0, and every node moves DOWN (new index <= old
+// index). Step 3 can therefore run front to back in the same vector without
+// overwriting a node before it has been moved.
+// ============================================================================
+
+// Helper: compact the arena down to the subtree under 'newRoot'
+std::size_t compactSubtree(MctsTree& tree, std::uint32_t newRoot) {
+    constexpr std::uint32_t dropped = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> forward(tree.nodes.size(), dropped);
+
+    std::vector<std::uint32_t> stack{newRoot};
+    forward[newRoot] = 0;
+    while (!stack.empty()) {
+        const MctsNode& node = tree.nodes[stack.back()];
+        stack.pop_back();
+        for (std::uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+            forward[i] = 0;
+            stack.push_back(i);
+        }
+    }
+
+    std::uint32_t kept = 0;
+    for (std::uint32_t& f : forward) f = f == dropped ? dropped : kept++;
+
+    for (std::size_t i = 0; i < tree.nodes.size(); ++i) {
+        if (forward[i] == dropped) continue;
+        MctsNode node = tree.nodes[i];
+        if (node.childCount > 0) node.firstChild = forward[node.firstChild];
+        tree.nodes[forward[i]] = node;
+    }
+    tree.nodes.resize(kept);
+    tree.nodes[0].move = -1;
+    return kept;
+}
+
+std::size_t mctsAdvance(const MnkRules& rules, MctsTree& tree, const MnkState& state) {
+    // Follow the tree from the root along the moves that lead to 'state':
+    // at each step the side to move must have exactly one new piece
+    std::uint32_t index = 0;
+    MnkState at = tree.root;
+    bool found = (at.x & ~state.x) == 0 && (at.o & ~state.o) == 0;
+    while (found && at.moves < state.moves) {
+        const Bitboard added = at.toMove == Cell::X ? state.x & ~at.x : state.o & ~at.o;
+        const MctsNode& node = tree.nodes[index];
+        const auto first = tree.nodes.begin() + node.firstChild;
+        const auto child = std::find_if(first, first + node.childCount, [&](const MctsNode& c) {
+            return (Bitboard{1} << c.move) == added;
+        });
+        found = __builtin_popcountll(added) == 1 && child != first + node.childCount;
+        if (found) {
+            index = static_cast<std::uint32_t>(child - tree.nodes.begin());
+            at = mnkPlay(rules, at, child->move);
+        }
+    }
+    if (!found || at.x != state.x || at.o != state.o) {
+        tree = makeMctsTree(state, tree.rng);
+        return 0;
+    }
+    tree.root = at;
+    return compactSubtree(tree, index);
+}
+
+MnkStrategy mctsStrategy(MctsConfig config, std::shared_ptr<MctsStats> stats) {
+    auto tree = std::make_shared<MctsTree>(makeMctsTree(mnkEmpty(), config.seed));
+    return [config, tree, stats](const MnkRules& rules, const MnkState& state) {
+        const std::size_t kept = config.reuse ? mctsAdvance(rules, *tree, state) : 0;
+        if (!config.reuse) *tree = makeMctsTree(state, tree->rng);
+        const std::uint32_t keptVisits = tree->nodes[0].visits;
+        mctsSearch(rules, *tree, config);
+        if (stats) *stats = MctsStats{kept, keptVisits, tree->nodes.size()};
+        return mctsBestMove(*tree);
+    };
+}
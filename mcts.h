@@ -0,0 +1,119 @@
+#ifndef TICTACTOE_MCTS_H
+#define TICTACTOE_MCTS_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// MONTE CARLO TREE SEARCH
+//
+// Alpha-beta needs an evaluation function; MCTS only needs the rules. Each
+// PLAYOUT:
+//   1. Selection  - walk down the tree, at each node picking the child with
+//                   the best UCT score (see below)
+//   2. Expansion  - reaching a node that has no children yet, add them all
+//   3. Simulation - from there, play random moves until the game ends
+//   4. Backup     - every node on the path records the result
+//
+// UCT ("upper confidence bounds applied to trees") balances trying the
+// moves that look best against trying the ones we know little about:
+//
+//   UCT = wins / visits + c * sqrt(ln(parent visits) / visits)
+//         ^ exploitation   ^ exploration: large for rarely tried moves
+//
+// After enough playouts the most-visited root move is the one to play.
+//
+// THE ARENA. Nodes live in one std::vector, and a node's children are a
+// contiguous block of it (firstChild, childCount) - indices instead of
+// pointers, no allocation per node, and siblings scanned during selection
+// sit next to each other in memory. Positions are not stored at all: the
+// selection walk replays the moves from the root state.
+//
+// SUBTREE REUSE. After our move and the opponent's reply, the node for the
+// new position is already in the tree, with all the playouts that went
+// through it. Instead of starting over we keep that subtree and throw the
+// rest away, COMPACTING the arena in place (a mark-compact garbage
+// collection, see mctsAdvance) so the retained nodes stay contiguous.
+// ============================================================================
+
+// ============================================================================
+// RAVE: ALL MOVES AS FIRST
+//
+// A playout through node n tells us about more than the one child it went
+// through. In a placement game a stone on cell c is worth much the same
+// whether it was placed now or five moves later, so EVERY cell the player to
+// move at n occupied later in the playout gets credit, as if it had been
+// played first ("all moves as first", AMAF). Each child therefore collects
+// AMAF statistics from far more playouts than its own visits - noisy, but
+// plentiful from the very first playouts.
+//
+// RAVE (rapid action value estimation) blends the two per child:
+//
+//   value = (1 - beta) * wins / visits + beta * amafWins / amafVisits
+//   beta  = sqrt(k / (3 * visits + k))
+//
+// With few visits beta is near 1 and the AMAF estimate dominates; as real
+// visits pile up beta falls towards 0 and the exact statistics take over.
+// k (raveEquivalence) is the visit count at which both weigh about the same.
+// ============================================================================
+
+struct MctsNode {
+    std::uint32_t firstChild = 0;   // arena index of the first child
+    std::uint16_t childCount = 0;   // 0 = not expanded yet
+    std::int16_t move = -1;         // move that led here (-1 at the root)
+    std::uint32_t visits = 0;
+    std::uint32_t amafVisits = 0;   // playouts through the parent in which this move's
+                                    // player took this cell at any point
+    // Results in HALF POINTS (win 2, draw 1, loss 0) for the player who made
+    // 'move'. Integers stay exact however long a tree is reused; a float
+    // stops changing when 0.5 is added to it beyond about 2^23.
+    std::uint64_t halfWins = 0;
+    std::uint64_t amafHalfWins = 0;
+};
+
+struct MctsTree {
+    MnkState root;                  // position at nodes[0]
+    std::vector<MctsNode> nodes;    // nodes[0] is the root
+    std::uint64_t rng;              // playout random number counter
+};
+
+struct MctsConfig {
+    int playouts = 10000;           // per move
+    double exploration = 1.4;       // the c in UCT
+    bool reuse = true;              // keep the subtree between moves
+    std::uint64_t seed = 1;
+    bool rave = false;              // blend in all-moves-as-first statistics
+    double raveEquivalence = 1000.0;   // the k in RAVE's beta
+};
+
+// A tree holding just the root
+MctsTree makeMctsTree(const MnkState& root, std::uint64_t seed);
+
+// Run config.playouts more playouts from the root (using config.exploration,
+// config.rave and config.raveEquivalence)
+void mctsSearch(const MnkRules& rules, MctsTree& tree, const MctsConfig& config);
+
+// Most visited root move (-1 if the root has no children)
+int mctsBestMove(const MctsTree& tree);
+
+// Move the root to 'state', which must follow from the current root by a
+// few moves. If the tree holds 'state', its subtree becomes the whole tree
+// (compacted to the front of the arena) and the number of nodes kept is
+// returned; otherwise the tree restarts from 'state' and 0 is returned.
+std::size_t mctsAdvance(const MnkRules& rules, MctsTree& tree, const MnkState& state);
+
+// Statistics of a strategy's most recent decision
+struct MctsStats {
+    std::size_t keptNodes = 0;       // nodes carried over from the last move
+    std::uint32_t keptVisits = 0;    // root visits carried over
+    std::size_t treeNodes = 0;       // nodes after searching
+};
+
+// MCTS strategy. The tree lives on between calls (shared by copies of the
+// strategy), so with config.reuse each move starts from the last search.
+// 'stats', if given, is filled in after every move.
+MnkStrategy mctsStrategy(MctsConfig config, std::shared_ptr<MctsStats> stats = nullptr);
+
+#endif // TICTACTOE_MCTS_H
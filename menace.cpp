@@ -0,0 +1,83 @@
+#include "menace.h"
+#include "tablebase.h"
+#include <algorithm>
+
+Menace makeMenace(const MnkRules& rules, const MenaceConfig& config, std::uint64_t seed) {
+    Menace menace{rules, config, std::vector<std::int32_t>(rankedPositionCount(rules.cells), -1), {}, {}, seed};
+
+    // Walk the canonical positions ply by ply, opening a box for each
+    std::vector<MnkState> layer{mnkEmpty()};
+    for (int ply = 0; !layer.empty(); ++ply) {
+        const int initial = config.initialBeads[std::min(ply / 2, 3)];
+        std::vector<MnkState> next;
+        for (const MnkState& state : layer) {
+            if (mnkIsGameOver(rules, state)) continue;
+            const std::size_t first = menace.beads.size();
+            menace.beads.resize(first + static_cast<std::size_t>(rules.cells), 0);
+            for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+                menace.beads[first + static_cast<std::size_t>(__builtin_ctzll(b))] = static_cast<std::uint16_t>(initial);
+
+                const MnkState child = mnkPlay(rules, state, __builtin_ctzll(b));
+                const auto [cx, co] = canonicalBitboards(rules, child.x, child.o);
+                std::int32_t& box = menace.boxOf[positionRank(rules.cells, cx, co)];
+                if (box == -1 && !mnkIsGameOver(rules, child)) {
+                    box = -2;   // queued; numbered when its layer is walked
+                    next.push_back(stateFromBitboards(rules, cx, co));
+                }
+            }
+            menace.boxOf[positionRank(rules.cells, state.x, state.o)] = static_cast<std::int32_t>(menace.totals.size());
+            menace.totals.push_back(static_cast<std::uint32_t>(initial * __builtin_popcountll(emptyCells(rules, state))));
+        }
+        layer = std::move(next);
+    }
+    return menace;
+}
+
+MenaceMove menaceDraw(Menace& menace, const MnkState& state) {
+    const MnkRules& rules = menace.rules;
+    const int symmetry = canonicalSymmetry(rules, state.x, state.o);
+    const std::int32_t box = menace.boxOf[positionRank(rules.cells, transformBitboard(rules, state.x, symmetry),
+                                                       transformBitboard(rules, state.o, symmetry))];
+
+    // Weighted draw: a random bead number, then find whose bead it is
+    const std::uint16_t* beads = &menace.beads[static_cast<std::size_t>(box) * static_cast<std::size_t>(rules.cells)];
+    std::uint32_t pick = static_cast<std::uint32_t>(splitMix64(menace.rng++) % menace.totals[static_cast<std::size_t>(box)]);
+    int bead = 0;
+    while (pick >= beads[bead]) pick -= beads[bead++];
+
+    // Undo the symmetry: the real cell is the one that lands on the bead
+    const std::vector<int>& image = rules.symmetries[symmetry];
+    const int cell = static_cast<int>(std::find(image.begin(), image.end(), bead) - image.begin());
+    return MenaceMove{box, static_cast<std::int16_t>(bead), static_cast<std::int16_t>(cell)};
+}
+
+void menaceReinforce(Menace& menace, const std::vector<MenaceMove>& moves, int delta) {
+    for (const MenaceMove& move : moves) {
+        const std::size_t box = static_cast<std::size_t>(move.box);
+        std::uint16_t& count = menace.beads[box * static_cast<std::size_t>(menace.rules.cells) + static_cast<std::size_t>(move.bead)];
+        // Never below one bead for a losing move that is the box's last
+        const int updated = std::clamp(static_cast<int>(count) + delta,
+                                       menace.totals[box] == count ? 1 : 0, 65535);
+        menace.totals[box] = menace.totals[box] - count + static_cast<std::uint32_t>(updated);
+        count = static_cast<std::uint16_t>(updated);
+    }
+}
+
+Cell menaceTrainGame(Menace& menace, Cell side, const MnkStrategy& opponent) {
+    std::vector<MenaceMove> moves;
+    const MnkStrategy learner = [&](const MnkRules&, const MnkState& state) {
+        moves.push_back(menaceDraw(menace, state));
+        return static_cast<int>(moves.back().cell);
+    };
+    const Cell winner = (side == Cell::X ? playMnkGame(menace.rules, learner, opponent)
+                                         : playMnkGame(menace.rules, opponent, learner)).second;
+    const MenaceConfig& config = menace.config;
+    menaceReinforce(menace, moves, winner == side ? config.win : winner == Cell::Empty ? config.draw : config.loss);
+    return winner;
+}
+
+MnkStrategy menaceStrategy(std::shared_ptr<Menace> menace) {
+    return [menace](const MnkRules&, const MnkState& state) {
+        return static_cast<int>(menaceDraw(*menace, state).cell);
+    };
+}
@@ -0,0 +1,76 @@
+#ifndef TICTACTOE_MENACE_H
+#define TICTACTOE_MENACE_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// MENACE
+//
+// Donald Michie's 1961 Machine Educable Noughts And Crosses Engine learned
+// tic-tac-toe with no computer at all: a matchbox for every position, holding
+// coloured beads, one colour per empty cell.
+//
+//   - To move, open the box for the current position and draw a bead at
+//     random; its colour is the move. Moves with more beads are likelier.
+//   - After the game, go back through the boxes that were used. Win: add 3
+//     beads of the colour played. Draw: add 1. Loss: take the bead away.
+//
+// Good moves multiply, bad ones die out, and after a few hundred games the
+// boxes play well - every decision can still be read straight off the bead
+// counts.
+//
+// Michie needed only ~300 boxes because symmetric positions share one: we do
+// the same with canonical forms (see canonicalBitboards). Boxes are numbered
+// 0, 1, 2, ... in order of discovery and found through a flat array indexed
+// by the canonical position's rank (the tablebase's perfect hash); the beads
+// of box b are the 'cells' counters starting at beads[b * cells], indexed by
+// cell in the canonical position's coordinates.
+//
+// A loss never takes a box's last bead - a strategy has to play something,
+// where Michie's MENACE would have resigned.
+// ============================================================================
+
+struct MenaceConfig {
+    int initialBeads[4] = {4, 3, 2, 1};   // per empty cell, for plies 0-1, 2-3, 4-5, 6+
+    int win = 3;
+    int draw = 1;
+    int loss = -1;
+};
+
+struct Menace {
+    MnkRules rules;
+    MenaceConfig config;
+    std::vector<std::int32_t> boxOf;     // canonical positionRank -> box, -1 if none
+    std::vector<std::uint16_t> beads;    // box * cells + canonical cell
+    std::vector<std::uint32_t> totals;   // beads in each box
+    std::uint64_t rng;                   // random number counter
+};
+
+// One draw from a box, as recorded for reinforcement
+struct MenaceMove {
+    std::int32_t box;
+    std::int16_t bead;   // the cell in canonical coordinates
+    std::int16_t cell;   // the same cell on the real board
+};
+
+// A box for every reachable unfinished position (one per symmetry class),
+// filled with the initial beads. The board must fit the tablebase ranking.
+Menace makeMenace(const MnkRules& rules, const MenaceConfig& config = {}, std::uint64_t seed = 1);
+
+// Draw a bead from the box for 'state' (which must not be finished)
+MenaceMove menaceDraw(Menace& menace, const MnkState& state);
+
+// Reinforce every draw of one game with 'delta' beads
+void menaceReinforce(Menace& menace, const std::vector<MenaceMove>& moves, int delta);
+
+// Play one game as 'side' against 'opponent', then learn from it.
+// Returns the winner.
+Cell menaceTrainGame(Menace& menace, Cell side, const MnkStrategy& opponent);
+
+// Play by drawing beads, without learning
+MnkStrategy menaceStrategy(std::shared_ptr<Menace> menace);
+
+#endif // TICTACTOE_MENACE_H
@@ -0,0 +1,388 @@
+#include "mlp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICTACTOE_MLP_AVX2 1
+#endif
+
+// Helper: round up to a multiple of 8 floats (one AVX2 register)
+constexpr int padTo8(int n) {
+    return (n + 7) / 8 * 8;
+}
+
+Mlp makeMlp(const MnkRules& rules, int hidden, std::uint64_t seed) {
+    const int h = std::min(padTo8(std::max(hidden, 1)), maxMlpHidden);
+    const int outputs = padTo8(rules.cells + 1);
+    Mlp mlp{rules, h, outputs,
+            std::vector<float>(static_cast<std::size_t>(2 * rules.cells * h)), std::vector<float>(static_cast<std::size_t>(h)),
+            std::vector<float>(static_cast<std::size_t>(h * outputs)), std::vector<float>(static_cast<std::size_t>(outputs))};
+
+    // Uniform in +-1/sqrt(fan-in), the usual scale for a fresh layer
+    std::uint64_t counter = seed;
+    const auto fill = [&](std::vector<float>& weights, int fanIn) {
+        const float scale = 1.0f / std::sqrt(static_cast<float>(fanIn));
+        for (float& w : weights) {
+            w = scale * (static_cast<float>(splitMix64(counter++) >> 40) / static_cast<float>(1 << 23) - 1.0f);
+        }
+    };
+    fill(mlp.w1, 2 * rules.cells);
+    fill(mlp.w2, h);
+    // Padding outputs stay exactly 0
+    for (int j = 0; j < h; ++j) {
+        for (int o = rules.cells + 1; o < outputs; ++o) mlp.w2[static_cast<std::size_t>(j * outputs + o)] = 0.0f;
+    }
+    return mlp;
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+constexpr char mlpMagic[8] = {'T', 'T', 'T', 'M', 'L', 'P', '0', '1'};
+
+bool writeMlp(const Mlp& mlp, const std::string& path) {
+    const std::int32_t header[4] = {mlp.rules.rows, mlp.rules.cols, mlp.rules.k, mlp.hidden};
+    std::ofstream out(path, std::ios::binary);
+    out.write(mlpMagic, sizeof mlpMagic);
+    out.write(reinterpret_cast<const char*>(header), sizeof header);
+    for (const std::vector<float>* weights : {&mlp.w1, &mlp.b1, &mlp.w2, &mlp.b2}) {
+        out.write(reinterpret_cast<const char*>(weights->data()), static_cast<std::streamsize>(weights->size() * sizeof(float)));
+    }
+    return static_cast<bool>(out);
+}
+
+std::optional<Mlp> loadMlp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[8] = {};
+    std::int32_t header[4] = {};
+    if (!in.read(magic, sizeof magic) || std::memcmp(magic, mlpMagic, sizeof magic) != 0 ||
+        !in.read(reinterpret_cast<char*>(header), sizeof header)) {
+        return std::nullopt;
+    }
+    const auto [rows, cols, k, hidden] = header;
+    if (rows <= 0 || cols <= 0 || rows * cols > maxCells || hidden <= 0 || hidden % 8 != 0 || hidden > maxMlpHidden) {
+        return std::nullopt;
+    }
+    Mlp mlp = makeMlp(makeRules(rows, cols, k), hidden, 0);
+    for (std::vector<float>* weights : {&mlp.w1, &mlp.b1, &mlp.w2, &mlp.b2}) {
+        in.read(reinterpret_cast<char*>(weights->data()), static_cast<std::streamsize>(weights->size() * sizeof(float)));
+    }
+    // Exactly the expected number of bytes: no more, no less
+    return in && in.peek() == std::ifstream::traits_type::eof() ? std::optional{std::move(mlp)} : std::nullopt;
+}
+
+// ============================================================================
+// Kernels
+//
+// Both kernels compute the same sums in the same order per lane, so they
+// agree up to the rounding difference of a fused multiply-add.
+// ============================================================================
+
+// Helper: the hidden rows to add - own pieces, then the opponent's
+std::pair<Bitboard, Bitboard> inputPlanes(const MnkState& state) {
+    return {ownPieces(state), opponentPieces(state)};
+}
+
+// Helper: the plain C++ kernel. 'out' holds mlp.outputs floats.
+void forwardScalar(const Mlp& mlp, const MnkState& state, float* out) {
+    const int h = mlp.hidden;
+    const int cells = mlp.rules.cells;
+    float hidden[maxMlpHidden];
+    std::memcpy(hidden, mlp.b1.data(), static_cast<std::size_t>(h) * sizeof(float));
+    const auto [own, opp] = inputPlanes(state);
+    for (int plane = 0; plane < 2; ++plane) {
+        for (Bitboard b = plane == 0 ? own : opp; b != 0; b &= b - 1) {
+            const float* row = &mlp.w1[static_cast<std::size_t>((plane * cells + __builtin_ctzll(b)) * h)];
+            for (int j = 0; j < h; ++j) hidden[j] += row[j];
+        }
+    }
+    std::memcpy(out, mlp.b2.data(), static_cast<std::size_t>(mlp.outputs) * sizeof(float));
+    for (int j = 0; j < h; ++j) {
+        const float activation = hidden[j];
+        if (activation <= 0.0f) continue;   // relu
+        const float* row = &mlp.w2[static_cast<std::size_t>(j * mlp.outputs)];
+        for (int o = 0; o < mlp.outputs; ++o) out[o] += activation * row[o];
+    }
+}
+
+#ifdef TICTACTOE_MLP_AVX2
+// Helper: the AVX2/FMA kernel, 8 floats per instruction
+__attribute__((target("avx2,fma")))
+void forwardAvx2(const Mlp& mlp, const MnkState& state, float* out) {
+    const int h = mlp.hidden;
+    const int cells = mlp.rules.cells;
+    alignas(32) float hidden[maxMlpHidden];
+
+    std::memcpy(hidden, mlp.b1.data(), static_cast<std::size_t>(h) * sizeof(float));
+    const auto [own, opp] = inputPlanes(state);
+    for (int plane = 0; plane < 2; ++plane) {
+        for (Bitboard b = plane == 0 ? own : opp; b != 0; b &= b - 1) {
+            const float* row = &mlp.w1[static_cast<std::size_t>((plane * cells + __builtin_ctzll(b)) * h)];
+            for (int j = 0; j < h; j += 8) {
+                _mm256_storeu_ps(hidden + j, _mm256_add_ps(_mm256_loadu_ps(hidden + j), _mm256_loadu_ps(row + j)));
+            }
+        }
+    }
+
+    // Up to 64 outputs (8 registers) stay in registers across the hidden loop
+    for (int block = 0; block < mlp.outputs; block += 64) {
+        const int width = std::min(64, mlp.outputs - block) / 8;
+        __m256 acc[8];
+        for (int r = 0; r < width; ++r) acc[r] = _mm256_loadu_ps(&mlp.b2[static_cast<std::size_t>(block + 8 * r)]);
+        for (int j = 0; j < h; ++j) {
+            if (hidden[j] <= 0.0f) continue;   // relu
+            const __m256 activation = _mm256_set1_ps(hidden[j]);
+            const float* row = &mlp.w2[static_cast<std::size_t>(j * mlp.outputs + block)];
+            for (int r = 0; r < width; ++r) acc[r] = _mm256_fmadd_ps(activation, _mm256_loadu_ps(row + 8 * r), acc[r]);
+        }
+        for (int r = 0; r < width; ++r) _mm256_storeu_ps(out + block + 8 * r, acc[r]);
+    }
+}
+#endif
+
+bool mlpAvx2Available() {
+#ifdef TICTACTOE_MLP_AVX2
+    static const bool available = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return available;
+#else
+    return false;
+#endif
+}
+
+MlpOutput mlpForward(const Mlp& mlp, const MnkState& state, MlpKernel kernel) {
+    alignas(32) float out[padTo8(maxCells + 1)];
+#ifdef TICTACTOE_MLP_AVX2
+    if (kernel != MlpKernel::Scalar && mlpAvx2Available()) forwardAvx2(mlp, state, out);
+    else forwardScalar(mlp, state, out);
+#else
+    (void)kernel;
+    forwardScalar(mlp, state, out);
+#endif
+    MlpOutput result{};
+    std::memcpy(result.logits.data(), out, static_cast<std::size_t>(mlp.rules.cells) * sizeof(float));
+    result.value = std::tanh(out[mlp.rules.cells]);
+    return result;
+}
+
+// ============================================================================
+// Batched Kernels
+// ============================================================================
+
+// Positions per tile of the batched second layer
+constexpr int batchTile = 4;
+
+// Helper: first layer for one position - relu(b1 + rows of its pieces)
+void hiddenLayer(const Mlp& mlp, const MnkState& state, float* hidden) {
+    const int h = mlp.hidden;
+    std::memcpy(hidden, mlp.b1.data(), static_cast<std::size_t>(h) * sizeof(float));
+    const auto [own, opp] = inputPlanes(state);
+    for (int plane = 0; plane < 2; ++plane) {
+        for (Bitboard b = plane == 0 ? own : opp; b != 0; b &= b - 1) {
+            const float* row = &mlp.w1[static_cast<std::size_t>((plane * mlp.rules.cells + __builtin_ctzll(b)) * h)];
+            for (int j = 0; j < h; ++j) hidden[j] += row[j];
+        }
+    }
+    for (int j = 0; j < h; ++j) hidden[j] = std::max(hidden[j], 0.0f);
+}
+
+// Helper: second layer for one tile, plain C++. hidden is [batchTile][h],
+// out is [batchTile][outputs].
+void outputTileScalar(const Mlp& mlp, const float* hidden, float* out) {
+    for (int p = 0; p < batchTile; ++p) {
+        float* row = out + p * mlp.outputs;
+        std::memcpy(row, mlp.b2.data(), static_cast<std::size_t>(mlp.outputs) * sizeof(float));
+        for (int j = 0; j < mlp.hidden; ++j) {
+            const float activation = hidden[p * mlp.hidden + j];
+            const float* weights = &mlp.w2[static_cast<std::size_t>(j * mlp.outputs)];
+            for (int o = 0; o < mlp.outputs; ++o) row[o] += activation * weights[o];
+        }
+    }
+}
+
+#ifdef TICTACTOE_MLP_AVX2
+// Helper: hiddenLayer with AVX2
+__attribute__((target("avx2,fma")))
+void hiddenLayerAvx2(const Mlp& mlp, const MnkState& state, float* hidden) {
+    const int h = mlp.hidden;
+    std::memcpy(hidden, mlp.b1.data(), static_cast<std::size_t>(h) * sizeof(float));
+    const auto [own, opp] = inputPlanes(state);
+    for (int plane = 0; plane < 2; ++plane) {
+        for (Bitboard b = plane == 0 ? own : opp; b != 0; b &= b - 1) {
+            const float* row = &mlp.w1[static_cast<std::size_t>((plane * mlp.rules.cells + __builtin_ctzll(b)) * h)];
+            for (int j = 0; j < h; j += 8) {
+                _mm256_storeu_ps(hidden + j, _mm256_add_ps(_mm256_loadu_ps(hidden + j), _mm256_loadu_ps(row + j)));
+            }
+        }
+    }
+    for (int j = 0; j < h; j += 8) _mm256_storeu_ps(hidden + j, _mm256_max_ps(_mm256_loadu_ps(hidden + j), _mm256_setzero_ps()));
+}
+
+// Helper: the same tile with AVX2/FMA: 4 positions x 16 outputs in 8
+// registers, each pair of W2 loads shared by the 4 positions
+__attribute__((target("avx2,fma")))
+void outputTileAvx2(const Mlp& mlp, const float* hidden, float* out) {
+    const int h = mlp.hidden;
+    for (int block = 0; block < mlp.outputs; block += 16) {
+        const bool pair = block + 16 <= mlp.outputs;   // else a last block of 8
+        __m256 acc[batchTile][2];
+        const __m256 bias0 = _mm256_loadu_ps(&mlp.b2[static_cast<std::size_t>(block)]);
+        const __m256 bias1 = pair ? _mm256_loadu_ps(&mlp.b2[static_cast<std::size_t>(block + 8)]) : _mm256_setzero_ps();
+        for (int p = 0; p < batchTile; ++p) {
+            acc[p][0] = bias0;
+            acc[p][1] = bias1;
+        }
+        for (int j = 0; j < h; ++j) {
+            const float* weights = &mlp.w2[static_cast<std::size_t>(j * mlp.outputs + block)];
+            const __m256 w0 = _mm256_loadu_ps(weights);
+            const __m256 w1 = pair ? _mm256_loadu_ps(weights + 8) : _mm256_setzero_ps();
+            for (int p = 0; p < batchTile; ++p) {
+                const __m256 activation = _mm256_broadcast_ss(hidden + p * h + j);
+                acc[p][0] = _mm256_fmadd_ps(activation, w0, acc[p][0]);
+                acc[p][1] = _mm256_fmadd_ps(activation, w1, acc[p][1]);
+            }
+        }
+        for (int p = 0; p < batchTile; ++p) {
+            _mm256_storeu_ps(out + p * mlp.outputs + block, acc[p][0]);
+            if (pair) _mm256_storeu_ps(out + p * mlp.outputs + block + 8, acc[p][1]);
+        }
+    }
+}
+#endif
+
+void mlpForwardBatch(const Mlp& mlp, const MnkState* states, int count, MlpOutput* outputs, MlpKernel kernel) {
+#ifdef TICTACTOE_MLP_AVX2
+    const bool avx2 = kernel != MlpKernel::Scalar && mlpAvx2Available();
+#else
+    (void)kernel;
+#endif
+    std::vector<float> hidden(static_cast<std::size_t>(batchTile * mlp.hidden));
+    std::vector<float> out(static_cast<std::size_t>(batchTile * mlp.outputs));
+    for (int first = 0; first < count; first += batchTile) {
+        // A short last tile repeats its last position; those rows are dropped
+        for (int p = 0; p < batchTile; ++p) {
+            const MnkState& state = states[std::min(first + p, count - 1)];
+            float* row = &hidden[static_cast<std::size_t>(p * mlp.hidden)];
+#ifdef TICTACTOE_MLP_AVX2
+            if (avx2) hiddenLayerAvx2(mlp, state, row);
+            else hiddenLayer(mlp, state, row);
+#else
+            hiddenLayer(mlp, state, row);
+#endif
+        }
+#ifdef TICTACTOE_MLP_AVX2
+        if (avx2) outputTileAvx2(mlp, hidden.data(), out.data());
+        else outputTileScalar(mlp, hidden.data(), out.data());
+#else
+        outputTileScalar(mlp, hidden.data(), out.data());
+#endif
+        for (int p = 0; p < batchTile && first + p < count; ++p) {
+            const float* row = &out[static_cast<std::size_t>(p * mlp.outputs)];
+            MlpOutput& result = outputs[first + p];
+            std::memcpy(result.logits.data(), row, static_cast<std::size_t>(mlp.rules.cells) * sizeof(float));
+            result.value = std::tanh(row[mlp.rules.cells]);
+        }
+    }
+}
+
+// ============================================================================
+// Training
+// ============================================================================
+
+MlpLoss mlpTrainBatch(Mlp& mlp, const TrainingBatch& batch, float learningRate, float weightDecay,
+                      float* losses) {
+    const int h = mlp.hidden;
+    const int cells = mlp.rules.cells;
+    std::vector<float> gw1(mlp.w1.size()), gb1(mlp.b1.size()), gw2(mlp.w2.size()), gb2(mlp.b2.size());
+    std::vector<float> hidden(static_cast<std::size_t>(h)), out(static_cast<std::size_t>(mlp.outputs));
+    std::vector<float> dout(static_cast<std::size_t>(mlp.outputs)), dhidden(static_cast<std::size_t>(h));
+    const int count = static_cast<int>(batch.states.size());
+    MlpLoss loss;
+
+    for (int s = 0; s < count; ++s) {
+        const MnkState& state = batch.states[static_cast<std::size_t>(s)];
+        const float* policy = &batch.policies[static_cast<std::size_t>(s * cells)];
+        const float target = batch.values[static_cast<std::size_t>(s)];
+        double sampleLoss = 0.0;
+
+        // Forward, keeping the hidden layer
+        hiddenLayer(mlp, state, hidden.data());
+        std::copy(mlp.b2.begin(), mlp.b2.end(), out.begin());
+        for (int j = 0; j < h; ++j) {
+            for (int o = 0; o < mlp.outputs; ++o) out[o] += hidden[j] * mlp.w2[static_cast<std::size_t>(j * mlp.outputs + o)];
+        }
+
+        // Output gradients: softmax over the empty cells, tanh for the value
+        std::fill(dout.begin(), dout.end(), 0.0f);
+        const Bitboard empty = emptyCells(mlp.rules, state);
+        float largest = -1e30f;
+        for (Bitboard b = empty; b != 0; b &= b - 1) largest = std::max(largest, out[__builtin_ctzll(b)]);
+        float total = 0.0f;
+        for (Bitboard b = empty; b != 0; b &= b - 1) total += std::exp(out[__builtin_ctzll(b)] - largest);
+        for (Bitboard b = empty; b != 0; b &= b - 1) {
+            const int c = __builtin_ctzll(b);
+            const float p = std::exp(out[c] - largest) / total;
+            if (policy[c] > 0.0f) sampleLoss -= policy[c] * std::log(std::max(p, 1e-12f));
+            dout[c] = p - policy[c];
+        }
+        const float value = std::tanh(out[cells]);
+        loss.policy += sampleLoss;
+        loss.value += (value - target) * (value - target);
+        sampleLoss += (value - target) * (value - target);
+        if (losses != nullptr) losses[s] = static_cast<float>(sampleLoss);
+        dout[cells] = 2.0f * (value - target) * (1.0f - value * value);
+
+        // Backward through W2 and the relu
+        for (int o = 0; o < mlp.outputs; ++o) gb2[o] += dout[o];
+        for (int j = 0; j < h; ++j) {
+            float sum = 0.0f;
+            for (int o = 0; o <= cells; ++o) {
+                gw2[static_cast<std::size_t>(j * mlp.outputs + o)] += hidden[j] * dout[o];
+                sum += mlp.w2[static_cast<std::size_t>(j * mlp.outputs + o)] * dout[o];
+            }
+            dhidden[j] = hidden[j] > 0.0f ? sum : 0.0f;
+            gb1[j] += dhidden[j];
+        }
+        // ...and into the W1 rows of the pieces on the board
+        const auto [own, opp] = inputPlanes(state);
+        for (int plane = 0; plane < 2; ++plane) {
+            for (Bitboard b = plane == 0 ? own : opp; b != 0; b &= b - 1) {
+                float* row = &gw1[static_cast<std::size_t>((plane * cells + __builtin_ctzll(b)) * h)];
+                for (int j = 0; j < h; ++j) row[j] += dhidden[j];
+            }
+        }
+    }
+
+    const float step = learningRate / static_cast<float>(std::max(count, 1));
+    const auto apply = [&](std::vector<float>& weights, const std::vector<float>& gradient, float decay) {
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            weights[i] -= step * gradient[i] + learningRate * decay * weights[i];
+        }
+    };
+    apply(mlp.w1, gw1, weightDecay);
+    apply(mlp.b1, gb1, 0.0f);
+    apply(mlp.w2, gw2, weightDecay);
+    apply(mlp.b2, gb2, 0.0f);
+    loss.policy /= std::max(count, 1);
+    loss.value /= std::max(count, 1);
+    return loss;
+}
+
+int mlpBestMove(const MnkRules& rules, const MnkState& state, const MlpOutput& output) {
+    int best = -1;
+    for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+        const int cell = __builtin_ctzll(b);
+        if (best < 0 || output.logits[static_cast<std::size_t>(cell)] > output.logits[static_cast<std::size_t>(best)]) best = cell;
+    }
+    return best;
+}
+
+MnkStrategy mlpStrategy(std::shared_ptr<const Mlp> mlp) {
+    return [mlp](const MnkRules& rules, const MnkState& state) {
+        // A net for another board would read weight rows that do not exist
+        const bool sameRules = rules.rows == mlp->rules.rows && rules.cols == mlp->rules.cols && rules.k == mlp->rules.k;
+        return sameRules ? mlpBestMove(rules, state, mlpForward(*mlp, state)) : -1;
+    };
+}
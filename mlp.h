@@ -0,0 +1,131 @@
+#ifndef TICTACTOE_MLP_H
+#define TICTACTOE_MLP_H
+
+#include "mnk.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// A TINY NEURAL NETWORK
+//
+// A multilayer perceptron with one hidden layer, small enough to run inside
+// a search hundreds of thousands of times a second on one core:
+//
+//   input   2 planes of 'cells' bits: pieces of the side to move, pieces of
+//           the opponent (so the net never needs to know who is X)
+//   hidden  h = relu(b1 + W1 * input)
+//   output  b2 + W2 * h = one LOGIT per cell (how much the net likes that
+//           move; softmax over the empty cells gives move probabilities)
+//           plus a VALUE, squashed by tanh into -1 (lost) .. +1 (won)
+//
+// Both layers are computed as sums of weight ROWS, which is what makes them
+// fast:
+//   - The input is 0/1 and mostly 0, so W1 * input is just the sum of the
+//     W1 rows of the occupied cells - a few additions, no multiplications.
+//   - W2 is stored hidden-major: output += h[j] * (row j of W2) for each
+//     hidden unit, skipping the units relu set to 0.
+// Rows are padded to multiples of 8 floats so each is a whole number of
+// AVX2 registers; the AVX2/FMA kernel adds or multiply-adds 8 floats per
+// instruction. It is compiled for AVX2 with a function attribute and chosen
+// at run time, so the binary still runs (on the plain kernel) without it.
+//
+// FILE FORMAT: the 8-byte magic "TTTMLP01", int32 rows, cols, k and hidden,
+// then the floats of W1, b1, W2 and b2 in that order, all little-endian as
+// laid out in memory here. writeMlp produces it; so can any other tool.
+// ============================================================================
+
+// Largest hidden layer; the kernels keep it on the stack
+constexpr int maxMlpHidden = 512;
+
+struct Mlp {
+    MnkRules rules;
+    int hidden;               // multiple of 8, at most maxMlpHidden
+    int outputs;              // cells + 1 (the value), rounded up to a multiple of 8
+    std::vector<float> w1;    // [2 * cells][hidden]: own-piece rows, then opponent rows
+    std::vector<float> b1;    // [hidden]
+    std::vector<float> w2;    // [hidden][outputs]
+    std::vector<float> b2;    // [outputs]
+};
+
+struct MlpOutput {
+    std::array<float, maxCells> logits;   // by cell; only the first rules.cells are used
+    float value;                          // for the side to move, -1 .. +1
+};
+
+enum class MlpKernel { Best, Scalar, Avx2 };
+
+// A net with small random weights ('hidden' is rounded up to a multiple of
+// 8 and capped at maxMlpHidden)
+Mlp makeMlp(const MnkRules& rules, int hidden, std::uint64_t seed);
+
+// Save to / load from a flat binary file
+bool writeMlp(const Mlp& mlp, const std::string& path);
+std::optional<Mlp> loadMlp(const std::string& path);
+
+// Does this CPU run the AVX2/FMA kernel?
+bool mlpAvx2Available();
+
+// Run the net on a position. Asking for Avx2 on a CPU without it runs the
+// scalar kernel.
+MlpOutput mlpForward(const Mlp& mlp, const MnkState& state, MlpKernel kernel = MlpKernel::Best);
+
+// ============================================================================
+// BATCHES
+//
+// One position at a time, the second layer reads all of W2 to produce one
+// output row: every weight fetched is used once. For a BATCH of positions
+// the layer is a matrix-matrix product (batch x hidden) * (hidden x outputs),
+// and the kernel works on tiles - 4 positions by 16 outputs - so each W2
+// load feeds 4 multiply-adds instead of 1. The relu skip is given up (the
+// zeros differ between positions); the reuse more than pays for it.
+// ============================================================================
+
+// Run the net on states[0..count), writing outputs[0..count)
+void mlpForwardBatch(const Mlp& mlp, const MnkState* states, int count, MlpOutput* outputs,
+                     MlpKernel kernel = MlpKernel::Best);
+
+// ============================================================================
+// TRAINING
+//
+// Stochastic gradient descent on a batch of samples. Each sample says what
+// the net SHOULD output for a position:
+//   policy  a probability per cell (0 on occupied cells) - e.g. how often a
+//           search chose each move
+//   value   the result from the side to move's point of view, -1 .. +1
+// and the loss is  cross-entropy(policy, softmax of the empty cells' logits)
+// + (value - tanh output)^2. Backpropagation is written out by hand: with
+// one hidden layer it is a few loops, the mirror image of the forward pass.
+//
+// A batch is stored as contiguous arrays, one entry per sample, rather than
+// as an array of samples: see replay.h for where batches come from.
+// ============================================================================
+
+struct TrainingBatch {
+    std::vector<MnkState> states;
+    std::vector<float> policies;   // [sample][cells]
+    std::vector<float> values;     // for the side to move
+};
+
+struct MlpLoss {
+    double policy = 0.0;           // average cross-entropy
+    double value = 0.0;            // average squared error
+};
+
+// One gradient step on the batch: every weight moves by
+// -learningRate * (average gradient + weightDecay * weight). If 'losses' is
+// given it receives each sample's loss (policy + value).
+MlpLoss mlpTrainBatch(Mlp& mlp, const TrainingBatch& batch, float learningRate, float weightDecay,
+                      float* losses = nullptr);
+
+// The empty cell with the highest logit (-1 if the board is full)
+int mlpBestMove(const MnkRules& rules, const MnkState& state, const MlpOutput& output);
+
+// Play the empty cell with the highest logit. On a board with other rules
+// than the net's it returns -1, which playMnkGame scores as a draw.
+MnkStrategy mlpStrategy(std::shared_ptr<const Mlp> mlp);
+
+#endif // TICTACTOE_MLP_H
@@ -0,0 +1,317 @@
+#include "mnk.h"
+#include <algorithm>
+#include <numeric>
+#include <cstdlib>
+#include <tuple>
+
+// ============================================================================
+// BIT TRICKS USED IN THIS FILE
+//
+//   Bitboard{1} << i      - a bitboard with only cell i set
+//   b & (b - 1)           - b with its lowest set bit cleared
+//   __builtin_ctzll(b)    - index of the lowest set bit ("count trailing zeros")
+//   __builtin_popcountll  - number of set bits
+//
+// The __builtin_ functions are GCC/Clang intrinsics that compile to single
+// CPU instructions on x86-64 and ARM64.
+// ============================================================================
+
+// ============================================================================
+// Rules and Line Tables
+// ============================================================================
+
+// Helper: bitboard of the k cells starting at (row, col) going (dr, dc),
+// or 0 if the window runs off the board
+Bitboard lineMask(int rows, int cols, int k, int row, int col, int dr, int dc) {
+    return (row + dr * (k - 1) >= 0 && row + dr * (k - 1) < rows &&
+            col + dc * (k - 1) >= 0 && col + dc * (k - 1) < cols)
+        ? [&]() {
+            Bitboard mask = 0;
+            for (int i = 0; i < k; ++i) {
+                mask |= Bitboard{1} << ((row + dr * i) * cols + (col + dc * i));
+            }
+            return mask;
+          }()
+        : Bitboard{0};
+}
+
+MnkRules makeRules(int rows, int cols, int k) {
+    MnkRules rules{rows, cols, k, rows * cols,
+                   rows * cols == maxCells ? ~Bitboard{0} : (Bitboard{1} << (rows * cols)) - 1,
+                   {}, std::vector<std::vector<int>>(rows * cols), {}};
+
+    // Every window of k cells in the four line directions:
+    // right, down, down-right, down-left
+    constexpr std::array<std::array<int, 2>, 4> directions = {{{0, 1}, {1, 0}, {1, 1}, {1, -1}}};
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            for (const auto& d : directions) {
+                Bitboard mask = lineMask(rows, cols, k, r, c, d[0], d[1]);
+                // k == 1 would list the same single cell four times
+                if (mask != 0 && std::find(rules.lines.begin(), rules.lines.end(), mask) == rules.lines.end()) {
+                    rules.lines.push_back(mask);
+                }
+            }
+        }
+    }
+
+    // Cell permutations for every symmetry of the board
+    const auto mapping = [&](auto image) {
+        std::vector<int> cells(rows * cols);
+        for (int cell = 0; cell < rows * cols; ++cell) {
+            const Position p = image(cell / cols, cell % cols);
+            cells[cell] = p.row * cols + p.col;
+        }
+        return cells;
+    };
+    rules.symmetries.push_back(mapping([&](int r, int c) { return Position{r, c}; }));
+    rules.symmetries.push_back(mapping([&](int r, int c) { return Position{rows - 1 - r, cols - 1 - c}; }));
+    rules.symmetries.push_back(mapping([&](int r, int c) { return Position{r, cols - 1 - c}; }));
+    rules.symmetries.push_back(mapping([&](int r, int c) { return Position{rows - 1 - r, c}; }));
+    if (rows == cols) {
+        rules.symmetries.push_back(mapping([&](int r, int c) { return Position{c, r}; }));
+        rules.symmetries.push_back(mapping([&](int r, int c) { return Position{cols - 1 - c, rows - 1 - r}; }));
+        rules.symmetries.push_back(mapping([&](int r, int c) { return Position{c, rows - 1 - r}; }));
+        rules.symmetries.push_back(mapping([&](int r, int c) { return Position{cols - 1 - c, r}; }));
+    }
+
+    // Index the lines by the cells they pass through, so that after a move
+    // we only look at lines that could have just been completed
+    for (int i = 0; i < static_cast<int>(rules.lines.size()); ++i) {
+        for (Bitboard b = rules.lines[i]; b != 0; b &= b - 1) {
+            rules.linesThrough[__builtin_ctzll(b)].push_back(i);
+        }
+    }
+    return rules;
+}
+
+MnkRules classicRules() {
+    return makeRules(3, 3, 3);
+}
+
+int playerIndex(Cell player) {
+    return player == Cell::X ? 0 : 1;
+}
+
+int cellIndex(const MnkRules& rules, Position pos) {
+    return pos.row * rules.cols + pos.col;
+}
+
+Position cellPosition(const MnkRules& rules, int cell) {
+    return Position{cell / rules.cols, cell % rules.cols};
+}
+
+// ============================================================================
+// State Functions
+// ============================================================================
+
+MnkState mnkEmpty() {
+    return MnkState{0, 0, 0, 0, Cell::X, Cell::Empty};
+}
+
+Bitboard ownPieces(const MnkState& state) {
+    return state.toMove == Cell::X ? state.x : state.o;
+}
+
+Bitboard opponentPieces(const MnkState& state) {
+    return state.toMove == Cell::X ? state.o : state.x;
+}
+
+Bitboard emptyCells(const MnkRules& rules, const MnkState& state) {
+    return rules.fullMask & ~(state.x | state.o);
+}
+
+// Helper: did placing on 'cell' complete a line for the owner of 'pieces'?
+// Only the lines through that cell can have changed.
+bool completesLine(const MnkRules& rules, Bitboard pieces, int cell) {
+    return std::any_of(rules.linesThrough[cell].begin(), rules.linesThrough[cell].end(),
+        [&](int line) { return (pieces & rules.lines[line]) == rules.lines[line]; });
+}
+
+MnkState mnkPlay(const MnkRules& rules, const MnkState& state, int cell) {
+    // Incremental update: one OR for the piece, one XOR for the key,
+    // and a check of only the lines through the new piece
+    return [&]() {
+        const Bitboard bit = Bitboard{1} << cell;
+        const Bitboard x = state.toMove == Cell::X ? (state.x | bit) : state.x;
+        const Bitboard o = state.toMove == Cell::O ? (state.o | bit) : state.o;
+        const Bitboard mine = state.toMove == Cell::X ? x : o;
+        return MnkState{
+            x, o,
+            state.key ^ zobristKeys[playerIndex(state.toMove)][cell],
+            state.moves + 1,
+            nextPlayer(state.toMove),
+            completesLine(rules, mine, cell) ? state.toMove : Cell::Empty};
+    }();
+}
+
+std::optional<MnkState> mnkMakeMove(const MnkRules& rules, const MnkState& state, int cell) {
+    return (cell >= 0 && cell < rules.cells && !mnkIsGameOver(rules, state) &&
+            (emptyCells(rules, state) & (Bitboard{1} << cell)) != 0)
+        ? std::optional{mnkPlay(rules, state, cell)}
+        : std::nullopt;
+}
+
+bool mnkIsGameOver(const MnkRules& rules, const MnkState& state) {
+    return state.winner != Cell::Empty || state.moves == rules.cells;
+}
+
+std::vector<int> mnkValidMoves(const MnkRules& rules, const MnkState& state) {
+    std::vector<int> moves;
+    for (Bitboard b = mnkIsGameOver(rules, state) ? 0 : emptyCells(rules, state); b != 0; b &= b - 1) {
+        moves.push_back(__builtin_ctzll(b));
+    }
+    return moves;
+}
+
+std::uint64_t computeKey(Bitboard x, Bitboard o) {
+    std::uint64_t key = 0;
+    for (Bitboard b = x; b != 0; b &= b - 1) key ^= zobristKeys[0][__builtin_ctzll(b)];
+    for (Bitboard b = o; b != 0; b &= b - 1) key ^= zobristKeys[1][__builtin_ctzll(b)];
+    return key;
+}
+
+Cell computeWinner(const MnkRules& rules, Bitboard x, Bitboard o) {
+    return std::any_of(rules.lines.begin(), rules.lines.end(), [&](Bitboard m) { return (x & m) == m; })
+        ? Cell::X
+        : std::any_of(rules.lines.begin(), rules.lines.end(), [&](Bitboard m) { return (o & m) == m; })
+        ? Cell::O
+        : Cell::Empty;
+}
+
+MnkState stateFromBitboards(const MnkRules& rules, Bitboard x, Bitboard o) {
+    return MnkState{
+        x, o, computeKey(x, o),
+        __builtin_popcountll(x | o),
+        __builtin_popcountll(x) > __builtin_popcountll(o) ? Cell::O : Cell::X,
+        computeWinner(rules, x, o)};
+}
+
+MnkState stateFromBoard(const Board& board) {
+    // Fold over all 9 positions, setting one bit per occupied cell
+    return stateFromBitboards(classicRules(),
+        std::accumulate(allPositions.begin(), allPositions.end(), Bitboard{0},
+            [&](Bitboard acc, const Position& p) {
+                return getCell(board, p) == Cell::X ? acc | (Bitboard{1} << (p.row * 3 + p.col)) : acc;
+            }),
+        std::accumulate(allPositions.begin(), allPositions.end(), Bitboard{0},
+            [&](Bitboard acc, const Position& p) {
+                return getCell(board, p) == Cell::O ? acc | (Bitboard{1} << (p.row * 3 + p.col)) : acc;
+            }));
+}
+
+// Helper: display character for one cell of a state
+char stateCellChar(const MnkState& state, int cell) {
+    return (state.x >> cell) & 1 ? 'X' : (state.o >> cell) & 1 ? 'O' : ' ';
+}
+
+std::string stateToString(const MnkRules& rules, const MnkState& state) {
+    std::string out;
+    for (int r = 0; r < rules.rows; ++r) {
+        for (int c = 0; c < rules.cols; ++c) {
+            out += std::string(" ") + stateCellChar(state, r * rules.cols + c) + (c + 1 < rules.cols ? " |" : "\n");
+        }
+        for (int c = 0; r + 1 < rules.rows && c < rules.cols; ++c) {
+            out += c + 1 < rules.cols ? "---|" : "---\n";
+        }
+    }
+    return out;
+}
+
+// ============================================================================
+// Symmetry
+// ============================================================================
+
+Bitboard transformBitboard(const MnkRules& rules, Bitboard bits, int symmetry) {
+    Bitboard out = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        out |= Bitboard{1} << rules.symmetries[symmetry][__builtin_ctzll(bits)];
+    }
+    return out;
+}
+
+std::pair<Bitboard, Bitboard> canonicalBitboards(const MnkRules& rules, Bitboard x, Bitboard o) {
+    std::pair<Bitboard, Bitboard> best{x, o};
+    for (int s = 1; s < static_cast<int>(rules.symmetries.size()); ++s) {
+        const Bitboard tx = transformBitboard(rules, x, s);
+        const Bitboard to = transformBitboard(rules, o, s);
+        if (to < best.second || (to == best.second && tx < best.first)) best = {tx, to};
+    }
+    return best;
+}
+
+int canonicalSymmetry(const MnkRules& rules, Bitboard x, Bitboard o) {
+    const auto [cx, co] = canonicalBitboards(rules, x, o);
+    int s = 0;
+    while (transformBitboard(rules, x, s) != cx || transformBitboard(rules, o, s) != co) ++s;
+    return s;
+}
+
+// ============================================================================
+// Deduplication
+//
+// Different move orders reach the same position (X:0, O:4, X:8 and
+// X:8, O:4, X:0). Enumerating layer by layer and removing duplicates
+// turns the exponential game TREE into the much smaller position GRAPH.
+// Sorting on the Zobrist key groups equal positions cheaply, but two
+// DIFFERENT positions can share a key, so ties are broken on the bitboards
+// and only identical (x, o) pairs are merged - the counts stay exact.
+// ============================================================================
+
+// Helper: all children of a layer, with duplicate positions removed
+std::vector<MnkState> nextLayer(const MnkRules& rules, const std::vector<MnkState>& layer) {
+    std::vector<MnkState> children;
+    for (const MnkState& s : layer) {
+        for (int cell : mnkValidMoves(rules, s)) {
+            children.push_back(mnkPlay(rules, s, cell));
+        }
+    }
+    std::sort(children.begin(), children.end(),
+        [](const MnkState& a, const MnkState& b) {
+            return std::tie(a.key, a.x, a.o) < std::tie(b.key, b.x, b.o);
+        });
+    children.erase(std::unique(children.begin(), children.end(),
+        [](const MnkState& a, const MnkState& b) { return a.x == b.x && a.o == b.o; }), children.end());
+    return children;
+}
+
+std::vector<std::size_t> countDistinctPositions(const MnkRules& rules, int maxPly) {
+    std::vector<std::size_t> counts;
+    std::vector<MnkState> layer{mnkEmpty()};
+    for (int ply = 0; ply <= maxPly && !layer.empty(); ++ply) {
+        counts.push_back(layer.size());
+        layer = ply < maxPly ? nextLayer(rules, layer) : std::vector<MnkState>{};
+    }
+    return counts;
+}
+
+// ============================================================================
+// Playing Games
+// ============================================================================
+
+// Helper: recursive game loop, mirroring playGameStep for the 3x3 Board
+std::pair<MnkState, Cell> playMnkGameStep(const MnkRules& rules, const MnkState& state,
+                                          const MnkStrategy& xStrategy,
+                                          const MnkStrategy& oStrategy) {
+    return mnkIsGameOver(rules, state)
+        ? std::pair{state, state.winner}
+        : [&]() {
+            std::optional<MnkState> next = mnkMakeMove(rules, state,
+                (state.toMove == Cell::X ? xStrategy : oStrategy)(rules, state));
+            return next
+                ? playMnkGameStep(rules, *next, xStrategy, oStrategy)
+                : std::pair{state, Cell::Empty};
+          }();
+}
+
+std::pair<MnkState, Cell> playMnkGame(const MnkRules& rules,
+                                      const MnkStrategy& xStrategy,
+                                      const MnkStrategy& oStrategy) {
+    return playMnkGameStep(rules, mnkEmpty(), xStrategy, oStrategy);
+}
+
+int mnkRandomStrategy(const MnkRules& rules, const MnkState& state) {
+    return [](const std::vector<int>& moves) {
+        return moves.empty() ? -1 : moves[rand() % moves.size()];
+    }(mnkValidMoves(rules, state));
+}
@@ -0,0 +1,238 @@
+#ifndef TICTACTOE_MNK_H
+#define TICTACTOE_MNK_H
+
+#include "tictactoe.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// GENERALIZED BOARDS: THE m,n,k-GAME
+//
+// Tic-tac-toe is one member of a whole family of games. An "m,n,k-game" is
+// played on an m x n board and the first player with k in a row wins:
+//
+//   3,3,3  - ordinary tic-tac-toe
+//   4,4,3  - 4x4 board, three in a row wins
+//   5,5,4  - 5x5 board, four in a row wins
+//   15,15,5 - gomoku (too big for us - we stop at 64 cells)
+//
+// The 3x3 Board type in tictactoe.h is great for learning, but it does not
+// grow. This module keeps the same functional rules (immutable values, pure
+// functions, makeMove returns a NEW state) with a representation that does.
+// ============================================================================
+
+// ============================================================================
+// BITBOARDS
+//
+// Instead of an array of Cell values we store each player's pieces as the
+// bits of one 64-bit integer. Cell index i is bit i (row-major order):
+//
+//   3x3 board        cell indices      X bitboard for the board on the left
+//    X |   | O        0 | 1 | 2
+//   ---|---|---      ---|---|---       bit:  8 7 6 5 4 3 2 1 0
+//      | X |          3 | 4 | 5              1 0 0 0 1 0 0 0 1
+//   ---|---|---      ---|---|---
+//      |   | X        6 | 7 | 8
+//
+// Why bother?
+//   - Copying a whole position is copying a couple of integers
+//   - "Does X own this whole line?" is one AND and one compare:
+//       (x & lineMask) == lineMask
+//   - Counting pieces is one popcount instruction
+// ============================================================================
+using Bitboard = std::uint64_t;
+
+// Largest board we support: one bit per cell in a 64-bit integer
+constexpr int maxCells = 64;
+
+// Rules of one m,n,k-game plus lookup tables derived from them.
+// Build once with makeRules() and pass around by const reference.
+struct MnkRules {
+    int rows;
+    int cols;
+    int k;                                  // pieces in a row needed to win
+    int cells;                              // rows * cols
+    Bitboard fullMask;                      // one bit set for every cell
+    std::vector<Bitboard> lines;            // every k-cell winning window
+    std::vector<std::vector<int>> linesThrough;  // cell -> indices into lines
+    std::vector<std::vector<int>> symmetries;    // symmetry -> (cell -> image cell)
+};
+
+// ============================================================================
+// ZOBRIST HASHING
+//
+// A hash key for a position that is updated with ONE XOR per move instead
+// of being recomputed from the whole board.
+//
+// Give every (player, cell) pair a random 64-bit number. The key of a
+// position is the XOR of the numbers for every piece on the board:
+//
+//   key(board) = zobrist[X][c1] ^ zobrist[O][c2] ^ zobrist[X][c3] ^ ...
+//
+// XOR is its own inverse (a ^ b ^ b == a), so:
+//   - placing a piece:  newKey = key ^ zobrist[player][cell]
+//   - removing a piece: the exact same operation
+//
+// We don't need a separate "side to move" number: in a placement game the
+// side to move follows from how many pieces are on the board.
+//
+// The table is built at COMPILE TIME with the splitmix64 generator, so every
+// run (and every thread) sees the same keys and there is no global state to
+// initialize.
+// ============================================================================
+
+// splitmix64 - small, high quality 64-bit mixing function
+constexpr std::uint64_t splitMix64(std::uint64_t seed) {
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr std::array<std::array<std::uint64_t, maxCells>, 2> makeZobristKeys() {
+    std::array<std::array<std::uint64_t, maxCells>, 2> keys{};
+    for (int p = 0; p < 2; ++p) {
+        for (int c = 0; c < maxCells; ++c) {
+            keys[p][c] = splitMix64(static_cast<std::uint64_t>(p * maxCells + c + 1));
+        }
+    }
+    return keys;
+}
+
+// zobristKeys[playerIndex][cell]
+inline constexpr std::array<std::array<std::uint64_t, maxCells>, 2> zobristKeys =
+    makeZobristKeys();
+
+// ============================================================================
+// GAME STATE
+//
+// Everything about a position in one small value type. The Zobrist key and
+// the winner are CARRIED along: makeMove updates them from the previous
+// state instead of recomputing them from the board.
+// ============================================================================
+struct MnkState {
+    Bitboard x;           // cells holding an X
+    Bitboard o;           // cells holding an O
+    std::uint64_t key;    // Zobrist key of (x, o)
+    int moves;            // pieces on the board
+    Cell toMove;          // player whose turn it is
+    Cell winner;          // Cell::Empty until someone completes a line
+};
+
+// ============================================================================
+// Pure Functions
+// ============================================================================
+
+// Build the rules (and line tables) for an m,n,k-game.
+// Requires 1 <= rows * cols <= 64 and 1 <= k <= max(rows, cols).
+MnkRules makeRules(int rows, int cols, int k);
+
+// Standard tic-tac-toe rules (3,3,3)
+MnkRules classicRules();
+
+// Index of a player in per-player tables: X -> 0, O -> 1
+int playerIndex(Cell player);
+
+// Convert between (row, col) and cell index
+int cellIndex(const MnkRules& rules, Position pos);
+Position cellPosition(const MnkRules& rules, int cell);
+
+// The empty starting position (X to move)
+MnkState mnkEmpty();
+
+// Bitboard of the side to move / the side that just moved
+Bitboard ownPieces(const MnkState& state);
+Bitboard opponentPieces(const MnkState& state);
+
+// Bitboard of the empty cells
+Bitboard emptyCells(const MnkRules& rules, const MnkState& state);
+
+// Make a move - returns a NEW state with key and winner updated incrementally.
+// Returns nullopt if the cell is off the board or occupied, or the game is over.
+std::optional<MnkState> mnkMakeMove(const MnkRules& rules, const MnkState& state, int cell);
+
+// Same as mnkMakeMove, but without validation. Search code calls this on
+// cells it already knows are empty, so it skips the checks and the optional.
+MnkState mnkPlay(const MnkRules& rules, const MnkState& state, int cell);
+
+// Game over: someone has k in a row, or the board is full
+bool mnkIsGameOver(const MnkRules& rules, const MnkState& state);
+
+// All empty cells, in increasing index order (empty if the game is over)
+std::vector<int> mnkValidMoves(const MnkRules& rules, const MnkState& state);
+
+// Recompute the Zobrist key from scratch - O(pieces). Used to verify the
+// incremental key and as the baseline in the hashing benchmark.
+std::uint64_t computeKey(Bitboard x, Bitboard o);
+
+// Winner of a full position, found by scanning every line (slow path)
+Cell computeWinner(const MnkRules& rules, Bitboard x, Bitboard o);
+
+// Build a state from bitboards (side to move, key and winner derived)
+MnkState stateFromBitboards(const MnkRules& rules, Bitboard x, Bitboard o);
+
+// Convert a classic 3x3 Board into a (3,3,3) state
+MnkState stateFromBoard(const Board& board);
+
+// Convert state to string for display (same layout as boardToString)
+std::string stateToString(const MnkRules& rules, const MnkState& state);
+
+// ============================================================================
+// SYMMETRY
+//
+// Rotating or reflecting a board doesn't change who is winning. A square board
+// has 8 symmetries (4 rotations, each optionally mirrored); a rectangle has 4
+// (identity, half turn, and the two mirrors). rules.symmetries[s][cell] is
+// where 'cell' lands under symmetry s; symmetry 0 is the identity.
+//
+// The CANONICAL form of a position is the image with the smallest (o, x)
+// bitboards. Symmetric positions share a canonical form, so storing only
+// canonical forms stores each position once instead of up to 8 times.
+// ============================================================================
+
+// Apply symmetry s to the cells of a bitboard
+Bitboard transformBitboard(const MnkRules& rules, Bitboard bits, int symmetry);
+
+// Canonical (x, o) bitboards of a position
+std::pair<Bitboard, Bitboard> canonicalBitboards(const MnkRules& rules, Bitboard x, Bitboard o);
+
+// A symmetry that takes (x, o) to its canonical form
+int canonicalSymmetry(const MnkRules& rules, Bitboard x, Bitboard o);
+
+// ============================================================================
+// Deduplication
+// ============================================================================
+
+// Number of DISTINCT positions reachable at each ply (index 0 = empty board),
+// counted by deduplicating every layer on its bitboards (exact, even when two
+// positions share a Zobrist key).
+std::vector<std::size_t> countDistinctPositions(const MnkRules& rules, int maxPly);
+
+// ============================================================================
+// Higher-Order Functions
+//
+// The classic Strategy is a plain function pointer, so it cannot carry any
+// state of its own. Search strategies need some (a transposition table shared
+// between moves and threads, a time limit, ...), so generalized strategies
+// are std::function objects: anything callable, including lambdas that
+// capture their state.
+// ============================================================================
+
+// Strategy for generalized boards: returns the cell to play
+using MnkStrategy = std::function<int(const MnkRules& rules, const MnkState& state)>;
+
+// Play a complete game with two strategies.
+// Returns pair of (final state, winner) - winner is Cell::Empty for a draw
+// or if a strategy returned an invalid move.
+std::pair<MnkState, Cell> playMnkGame(const MnkRules& rules,
+                                      const MnkStrategy& xStrategy,
+                                      const MnkStrategy& oStrategy);
+
+// Random valid move
+int mnkRandomStrategy(const MnkRules& rules, const MnkState& state);
+
+#endif // TICTACTOE_MNK_H
@@ -0,0 +1,151 @@
+#include "nnue.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICTACTOE_NNUE_AVX2 1
+#endif
+
+// Helper: scale that maps the largest magnitude in 'weights' to 127
+float int8Scale(const float* weights, std::size_t count) {
+    float largest = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) largest = std::max(largest, std::fabs(weights[i]));
+    return largest > 0.0f ? 127.0f / largest : 1.0f;
+}
+
+QuantNet quantizeMlp(const Mlp& mlp) {
+    const int cells = mlp.rules.cells;
+    const int hidden = (mlp.hidden + 15) / 16 * 16;
+    QuantNet net{mlp.rules, hidden,
+                 std::vector<std::int8_t>(static_cast<std::size_t>(2 * cells * hidden)),
+                 std::vector<std::int16_t>(static_cast<std::size_t>(hidden)),
+                 std::vector<std::int8_t>(static_cast<std::size_t>(hidden)),
+                 mlp.b2[static_cast<std::size_t>(cells)], 1.0f};
+
+    const float s1 = int8Scale(mlp.w1.data(), mlp.w1.size());
+    for (int input = 0; input < 2 * cells; ++input) {
+        for (int j = 0; j < mlp.hidden; ++j) {
+            net.w1[static_cast<std::size_t>(input * hidden + j)] =
+                static_cast<std::int8_t>(std::lround(mlp.w1[static_cast<std::size_t>(input * mlp.hidden + j)] * s1));
+        }
+    }
+    for (int j = 0; j < mlp.hidden; ++j) {
+        net.b1[static_cast<std::size_t>(j)] =
+            static_cast<std::int16_t>(std::clamp(std::lround(mlp.b1[static_cast<std::size_t>(j)] * s1), -16000l, 16000l));
+    }
+
+    // The value head is column 'cells' of the hidden-major W2
+    std::vector<float> head(static_cast<std::size_t>(mlp.hidden));
+    for (int j = 0; j < mlp.hidden; ++j) head[static_cast<std::size_t>(j)] = mlp.w2[static_cast<std::size_t>(j * mlp.outputs + cells)];
+    const float s2 = int8Scale(head.data(), head.size());
+    for (int j = 0; j < mlp.hidden; ++j) {
+        net.w2[static_cast<std::size_t>(j)] = static_cast<std::int8_t>(std::lround(head[static_cast<std::size_t>(j)] * s2));
+    }
+    net.outputScale = 1.0f / (s1 * s2);
+    return net;
+}
+
+// ============================================================================
+// Accumulator Updates
+// ============================================================================
+
+// Helper: the input row of 'player's piece on 'cell', as seen by 'view'
+const std::int8_t* inputRow(const QuantNet& net, int view, Cell player, int cell) {
+    const bool own = playerIndex(player) == view;
+    return &net.w1[static_cast<std::size_t>(((own ? 0 : net.rules.cells) + cell) * net.hidden)];
+}
+
+#ifdef TICTACTOE_NNUE_AVX2
+// Helper: sums += sign * row, 16 lanes per instruction
+__attribute__((target("avx2")))
+void addRowAvx2(std::int16_t* sums, const std::int8_t* row, int hidden, bool subtract) {
+    for (int j = 0; j < hidden; j += 16) {
+        const __m256i weights = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j)));
+        __m256i* lane = reinterpret_cast<__m256i*>(sums + j);
+        _mm256_store_si256(lane, subtract ? _mm256_sub_epi16(_mm256_load_si256(lane), weights)
+                                          : _mm256_add_epi16(_mm256_load_si256(lane), weights));
+    }
+}
+#endif
+
+// Helper: sums += sign * row
+void addRow(std::int16_t* sums, const std::int8_t* row, int hidden, bool subtract) {
+#ifdef TICTACTOE_NNUE_AVX2
+    if (mlpAvx2Available()) {
+        addRowAvx2(sums, row, hidden, subtract);
+        return;
+    }
+#endif
+    for (int j = 0; j < hidden; ++j) sums[j] = static_cast<std::int16_t>(sums[j] + (subtract ? -row[j] : row[j]));
+}
+
+void nnueRefresh(const QuantNet& net, NnueAccumulator& accumulator, const MnkState& state) {
+    for (int view = 0; view < 2; ++view) {
+        std::copy(net.b1.begin(), net.b1.end(), accumulator.sums[view]);
+        for (Bitboard b = state.x; b != 0; b &= b - 1) {
+            addRow(accumulator.sums[view], inputRow(net, view, Cell::X, __builtin_ctzll(b)), net.hidden, false);
+        }
+        for (Bitboard b = state.o; b != 0; b &= b - 1) {
+            addRow(accumulator.sums[view], inputRow(net, view, Cell::O, __builtin_ctzll(b)), net.hidden, false);
+        }
+    }
+}
+
+void nnueAdd(const QuantNet& net, NnueAccumulator& accumulator, Cell player, int cell) {
+    addRow(accumulator.sums[0], inputRow(net, 0, player, cell), net.hidden, false);
+    addRow(accumulator.sums[1], inputRow(net, 1, player, cell), net.hidden, false);
+}
+
+void nnueRemove(const QuantNet& net, NnueAccumulator& accumulator, Cell player, int cell) {
+    addRow(accumulator.sums[0], inputRow(net, 0, player, cell), net.hidden, true);
+    addRow(accumulator.sums[1], inputRow(net, 1, player, cell), net.hidden, true);
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+#ifdef TICTACTOE_NNUE_AVX2
+// Helper: sum of relu(sums[j]) * w2[j] - 16 products per madd instruction
+__attribute__((target("avx2")))
+std::int32_t valueDotAvx2(const std::int16_t* sums, const std::int8_t* w2, int hidden) {
+    __m256i total = _mm256_setzero_si256();
+    for (int j = 0; j < hidden; j += 16) {
+        const __m256i active = _mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(sums + j)),
+                                                _mm256_setzero_si256());
+        const __m256i weights = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w2 + j)));
+        total = _mm256_add_epi32(total, _mm256_madd_epi16(active, weights));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+// Helper: the same sum, one lane at a time
+std::int32_t valueDotScalar(const std::int16_t* sums, const std::int8_t* w2, int hidden) {
+    std::int32_t total = 0;
+    for (int j = 0; j < hidden; ++j) total += std::max<std::int32_t>(sums[j], 0) * w2[j];
+    return total;
+}
+
+// Helper: the value head's logit for 'toMove'
+float nnueLogit(const QuantNet& net, const NnueAccumulator& accumulator, Cell toMove) {
+    const std::int16_t* sums = accumulator.sums[playerIndex(toMove)];
+#ifdef TICTACTOE_NNUE_AVX2
+    const std::int32_t dot = mlpAvx2Available() ? valueDotAvx2(sums, net.w2.data(), net.hidden)
+                                                : valueDotScalar(sums, net.w2.data(), net.hidden);
+#else
+    const std::int32_t dot = valueDotScalar(sums, net.w2.data(), net.hidden);
+#endif
+    return static_cast<float>(dot) * net.outputScale + net.b2;
+}
+
+float nnueValue(const QuantNet& net, const NnueAccumulator& accumulator, Cell toMove) {
+    return std::tanh(nnueLogit(net, accumulator, toMove));
+}
+
+int nnueScore(const QuantNet& net, const NnueAccumulator& accumulator, Cell toMove) {
+    return static_cast<int>(std::lround(nnueLogit(net, accumulator, toMove) * static_cast<float>(nnueScoreScale)));
+}
@@ -0,0 +1,73 @@
+#ifndef TICTACTOE_NNUE_H
+#define TICTACTOE_NNUE_H
+
+#include "mlp.h"
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// EFFICIENTLY UPDATABLE NETWORKS (NNUE)
+//
+// Inside a search, consecutive evaluations differ by a piece or two. The
+// first layer of the MLP (see mlp.h) is a sum of one weight row per piece,
+// so the search can keep that sum - the ACCUMULATOR - up to date as it goes:
+//
+//   make move:  accumulator += row of (player, cell)
+//   undo move:  accumulator -= row of (player, cell)
+//
+// Evaluating a leaf then costs only the small second layer: relu of the
+// accumulator, dot the value weights. No pass over the board at all.
+//
+// The inputs are "own pieces / opponent pieces", which depends on who is to
+// move, so there are two accumulators side by side: one seen from X (X's
+// pieces are "own"), one seen from O. Every move updates both; a leaf reads
+// the one of the side to move.
+//
+// QUANTIZATION. Weights are int8 and the accumulator int16, so an AVX2
+// register holds 16 accumulator lanes instead of 8 floats, and a weight row
+// is a quarter of the bytes to fetch. The float weights are scaled so the
+// largest first-layer weight becomes 127:
+//
+//   int8 w = round(w * s1),      s1 = 127 / max |W1|
+//
+// With at most 64 pieces on the board a lane sums at most 64 * 127 = 8128
+// plus its bias, far from the int16 limit, so no clipping is needed and
+// relu stays exact. The value head is quantized the same way (s2) and
+// summed in int32; multiplying by 1 / (s1 * s2) gives back a float.
+// ============================================================================
+
+constexpr int maxNnueHidden = maxMlpHidden;
+
+// Leaf scores are the value head's logit times this (see leafScore)
+constexpr int nnueScoreScale = 100;
+
+struct QuantNet {
+    MnkRules rules;
+    int hidden;                       // multiple of 16
+    std::vector<std::int8_t> w1;      // [2 * cells][hidden]: own-piece rows, then opponent rows
+    std::vector<std::int16_t> b1;     // [hidden], at W1's scale
+    std::vector<std::int8_t> w2;      // [hidden]: the value head
+    float b2;
+    float outputScale;                // 1 / (s1 * s2)
+};
+
+struct NnueAccumulator {
+    alignas(32) std::int16_t sums[2][maxNnueHidden];   // [X's view, O's view][hidden]
+};
+
+// Quantize the first layer and the value head of a float network
+QuantNet quantizeMlp(const Mlp& mlp);
+
+// Recompute both accumulators from scratch
+void nnueRefresh(const QuantNet& net, NnueAccumulator& accumulator, const MnkState& state);
+
+// 'player' placed / took back a piece on 'cell'
+void nnueAdd(const QuantNet& net, NnueAccumulator& accumulator, Cell player, int cell);
+void nnueRemove(const QuantNet& net, NnueAccumulator& accumulator, Cell player, int cell);
+
+// Value for 'toMove': -1 .. +1 like MlpOutput::value, or as a search score
+// (logit * nnueScoreScale)
+float nnueValue(const QuantNet& net, const NnueAccumulator& accumulator, Cell toMove);
+int nnueScore(const QuantNet& net, const NnueAccumulator& accumulator, Cell toMove);
+
+#endif // TICTACTOE_NNUE_H
@@ -0,0 +1,102 @@
+#include "perft.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+// A position standing for 'count' move sequences (all of them reach it or
+// one of its symmetric images)
+struct GroupedPosition {
+    MnkState state;
+    std::uint64_t count;
+};
+
+// Helper: add a position reached by 'count' move sequences to a ply's totals
+void countNode(const MnkRules& rules, const MnkState& state, std::uint64_t count, PerftPly& ply) {
+    ply.nodes += count;
+    ply.xWins += state.winner == Cell::X ? count : 0;
+    ply.oWins += state.winner == Cell::O ? count : 0;
+    ply.draws += state.winner == Cell::Empty && state.moves == rules.cells ? count : 0;
+}
+
+// Helper: into += from * factor
+void addScaled(PerftPly& into, const PerftPly& from, std::uint64_t factor) {
+    into.nodes += from.nodes * factor;
+    into.xWins += from.xWins * factor;
+    into.oWins += from.oWins * factor;
+    into.draws += from.draws * factor;
+}
+
+// Helper: plain depth-first walk of one subtree - this is the part that
+// measures mnkPlay and move generation
+void perftFrom(const MnkRules& rules, const MnkState& state, int ply, int depth,
+               std::vector<PerftPly>& plies, std::uint64_t& visited) {
+    countNode(rules, state, 1, plies[ply]);
+    ++visited;
+    if (ply == depth || mnkIsGameOver(rules, state)) return;
+    for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+        perftFrom(rules, mnkPlay(rules, state, __builtin_ctzll(b)), ply + 1, depth, plies, visited);
+    }
+}
+
+// Helper: expand one grouped ply breadth-first, merging children that are
+// symmetric images of each other (same canonical key)
+std::vector<GroupedPosition> nextGroupedLayer(const MnkRules& rules, const std::vector<GroupedPosition>& layer) {
+    std::unordered_map<std::uint64_t, GroupedPosition> children;
+    for (const GroupedPosition& parent : layer) {
+        for (Bitboard b = mnkIsGameOver(rules, parent.state) ? 0 : emptyCells(rules, parent.state);
+             b != 0; b &= b - 1) {
+            const MnkState child = mnkPlay(rules, parent.state, __builtin_ctzll(b));
+            const auto [cx, co] = canonicalBitboards(rules, child.x, child.o);
+            children.try_emplace(computeKey(cx, co), GroupedPosition{child, 0}).first->second.count += parent.count;
+        }
+    }
+    std::vector<GroupedPosition> next;
+    next.reserve(children.size());
+    for (const auto& entry : children) next.push_back(entry.second);
+    return next;
+}
+
+PerftReport perft(const MnkRules& rules, const MnkState& start, int depth, int threads, int splitPly) {
+    PerftReport report;
+    report.plies.resize(static_cast<std::size_t>(std::max(depth, 0)) + 1);
+
+    // Grouped breadth-first plies
+    const int split = std::clamp(splitPly, 0, std::max(depth, 0));
+    std::vector<GroupedPosition> layer{{start, 1}};
+    for (int ply = 0; ply < split; ++ply) {
+        for (const GroupedPosition& g : layer) countNode(rules, g.state, g.count, report.plies[ply]);
+        report.visited += layer.size();
+        layer = nextGroupedLayer(rules, layer);
+    }
+    report.subtrees = layer.size();
+
+    // Depth-first subtrees, handed out one at a time
+    struct Partial {
+        std::vector<PerftPly> plies;
+        std::uint64_t visited = 0;
+    };
+    std::atomic<std::size_t> nextSubtree{0};
+    std::vector<Partial> partials(static_cast<std::size_t>(std::max(threads, 1)),
+                                  Partial{std::vector<PerftPly>(report.plies.size()), 0});
+    const auto work = [&](Partial& partial) {
+        std::vector<PerftPly> subtree(report.plies.size());
+        for (std::size_t i; (i = nextSubtree.fetch_add(1, std::memory_order_relaxed)) < layer.size();) {
+            std::fill(subtree.begin(), subtree.end(), PerftPly{});
+            perftFrom(rules, layer[i].state, split, depth, subtree, partial.visited);
+            for (std::size_t p = 0; p < subtree.size(); ++p) addScaled(partial.plies[p], subtree[p], layer[i].count);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < partials.size(); ++t) workers.emplace_back(work, std::ref(partials[t]));
+    work(partials[0]);
+    std::for_each(workers.begin(), workers.end(), [](std::thread& t) { t.join(); });
+
+    for (const Partial& partial : partials) {
+        for (std::size_t p = 0; p < report.plies.size(); ++p) addScaled(report.plies[p], partial.plies[p], 1);
+        report.visited += partial.visited;
+    }
+    for (const PerftPly& ply : report.plies) report.games += ply.xWins + ply.oWins + ply.draws;
+    return report;
+}
@@ -0,0 +1,185 @@
+#include "replay.h"
+#include <algorithm>
+#include <cstring>
+
+// Word offsets within a slot; the policy bytes start at word 5
+constexpr int sequenceWord = 0;
+constexpr int xWord = 1;
+constexpr int oWord = 2;
+constexpr int keyWord = 3;
+constexpr int valueWord = 4;
+constexpr int policyWord = 5;
+
+std::unique_ptr<ReplayStore> makeReplayStore(const MnkRules& rules, std::size_t capacity, int writers) {
+    auto store = std::make_unique<ReplayStore>();
+    store->rules = rules;
+    store->stride = policyWord + (rules.cells + 7) / 8;
+    const std::size_t shards = static_cast<std::size_t>(std::max(writers, 1));
+    store->shardCapacity = std::max<std::size_t>(capacity / shards, 1);
+    for (std::size_t s = 0; s < shards; ++s) {
+        auto shard = std::make_unique<ReplayShard>();
+        shard->words = std::vector<std::atomic<std::uint64_t>>(store->shardCapacity * static_cast<std::size_t>(store->stride));
+        shard->priorities = std::vector<std::atomic<float>>(store->shardCapacity);
+        store->shards.push_back(std::move(shard));
+    }
+    return store;
+}
+
+// Helper: bit pattern of a float and back, for the low half of the value word
+std::uint64_t floatBits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+
+float bitsFloat(std::uint64_t word) {
+    const auto bits = static_cast<std::uint32_t>(word);
+    float value;
+    std::memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+void replayAppend(ReplayStore& store, int writer, const MnkState& state, const float* policy, float value) {
+    ReplayShard& shard = *store.shards[static_cast<std::size_t>(writer)];
+    const std::uint64_t written = shard.written.load(std::memory_order_relaxed);   // only we change it
+    const std::size_t index = static_cast<std::size_t>(written % store.shardCapacity);
+    std::atomic<std::uint64_t>* slot = &shard.words[index * static_cast<std::size_t>(store.stride)];
+
+    // Sequence odd while the words are inconsistent
+    const std::uint64_t sequence = slot[sequenceWord].load(std::memory_order_relaxed);
+    slot[sequenceWord].store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot[xWord].store(state.x, std::memory_order_relaxed);
+    slot[oWord].store(state.o, std::memory_order_relaxed);
+    slot[keyWord].store(state.key, std::memory_order_relaxed);
+    // Policy bytes are laid out in memory order, byte c = cell c, and then
+    // moved into the words
+    std::uint64_t packed[maxCells / 8] = {};
+    auto* bytes = reinterpret_cast<unsigned char*>(packed);
+    std::uint64_t total = 0;
+    for (int c = 0; c < store.rules.cells; ++c) {
+        bytes[c] = static_cast<unsigned char>(std::clamp(policy[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+        total += bytes[c];
+    }
+    for (int w = 0; policyWord + w < store.stride; ++w) slot[policyWord + w].store(packed[w], std::memory_order_relaxed);
+    slot[valueWord].store(floatBits(value) | total << 32, std::memory_order_relaxed);
+    shard.priorities[index].store(store.maxPriority.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    slot[sequenceWord].store(sequence + 2, std::memory_order_release);
+    shard.written.store(written + 1, std::memory_order_release);
+}
+
+std::size_t replaySize(const ReplayStore& store) {
+    std::size_t size = 0;
+    for (const auto& shard : store.shards) {
+        size += static_cast<std::size_t>(std::min<std::uint64_t>(shard->written.load(std::memory_order_acquire), store.shardCapacity));
+    }
+    return size;
+}
+
+std::uint64_t replayAppended(const ReplayStore& store) {
+    std::uint64_t appended = 0;
+    for (const auto& shard : store.shards) appended += shard->written.load(std::memory_order_acquire);
+    return appended;
+}
+
+// ============================================================================
+// Sampling
+// ============================================================================
+
+// Helper: copy slot 'index' of 'shard' into entry 'entry' of the batch,
+// retrying while its writer is in the middle of it
+void unpackSlot(const ReplayStore& store, const ReplayShard& shard, std::size_t index, TrainingBatch& batch, std::size_t entry) {
+    const std::atomic<std::uint64_t>* slot = &shard.words[index * static_cast<std::size_t>(store.stride)];
+    const int cells = store.rules.cells;
+    std::uint64_t words[policyWord + maxCells / 8];
+    for (;;) {
+        const std::uint64_t before = slot[sequenceWord].load(std::memory_order_acquire);
+        for (int w = 1; w < store.stride; ++w) words[w] = slot[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && slot[sequenceWord].load(std::memory_order_relaxed) == before) break;
+    }
+
+    // Samples are positions with a move still to play, so there is no winner
+    // to look for (stateFromBitboards would scan every line)
+    const Bitboard x = words[xWord];
+    const Bitboard o = words[oWord];
+    const int moves = __builtin_popcountll(x | o);
+    batch.states[entry] = MnkState{x, o, words[keyWord], moves, moves % 2 == 0 ? Cell::X : Cell::O, Cell::Empty};
+    batch.values[entry] = bitsFloat(words[valueWord]);
+    // Bytes back to probabilities. Rounding to 1/255 leaves their sum a
+    // little off 255, so divide by the sum the writer stored instead.
+    const auto total = static_cast<std::uint32_t>(words[valueWord] >> 32);
+    const float scale = total > 0 ? 1.0f / static_cast<float>(total) : 0.0f;
+    // A plain loop over the bytes, which the compiler vectorizes
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&words[policyWord]);
+    float* policy = &batch.policies[entry * static_cast<std::size_t>(cells)];
+    for (int c = 0; c < cells; ++c) policy[c] = static_cast<float>(bytes[c]) * scale;
+}
+
+void replaySample(const ReplayStore& store, int count, ReplaySampling sampling, std::uint64_t& rng,
+                  TrainingBatch& batch, std::vector<std::uint64_t>* slots) {
+    // How full each shard is, as of now; later appends are simply not seen
+    std::vector<std::size_t> filled;
+    std::size_t total = 0;
+    for (const auto& shard : store.shards) {
+        filled.push_back(static_cast<std::size_t>(std::min<std::uint64_t>(shard->written.load(std::memory_order_acquire), store.shardCapacity)));
+        total += filled.back();
+    }
+    const std::size_t n = static_cast<std::size_t>(std::max(count, 0));
+    batch.states.resize(n);
+    batch.values.resize(n);
+    batch.policies.resize(n * static_cast<std::size_t>(store.rules.cells));
+    if (total == 0) {
+        if (slots != nullptr) slots->assign(n, 0);
+        return;
+    }
+
+    // First choose every slot, then copy them out. The copies are then
+    // independent loads the CPU can have in flight together, and the slot a
+    // few entries ahead is prefetched while the current one is unpacked.
+    const float maxPriority = store.maxPriority.load(std::memory_order_relaxed);
+    std::vector<std::pair<std::size_t, std::size_t>> chosen(n);   // (shard, index)
+    for (std::size_t entry = 0; entry < n; ++entry) {
+        std::size_t shard = 0;
+        std::size_t index = 0;
+        // Stochastic acceptance; give up being picky after a while so a few
+        // high priorities among many tiny ones cannot stall the trainer
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            std::size_t pick = static_cast<std::size_t>(splitMix64(rng++) % total);
+            for (shard = 0; pick >= filled[shard]; ++shard) pick -= filled[shard];
+            index = pick;
+            if (sampling == ReplaySampling::Uniform) break;
+            const float priority = store.shards[shard]->priorities[index].load(std::memory_order_relaxed);
+            const double accept = static_cast<double>(splitMix64(rng++) >> 11) * 0x1.0p-53;
+            if (accept * maxPriority < priority) break;
+        }
+        chosen[entry] = {shard, index};
+    }
+    // A slot may straddle two cache lines: prefetch its first and last word
+    const auto prefetch = [&](const std::pair<std::size_t, std::size_t>& slot) {
+        const std::atomic<std::uint64_t>* first = &store.shards[slot.first]->words[slot.second * static_cast<std::size_t>(store.stride)];
+        __builtin_prefetch(first);
+        __builtin_prefetch(first + store.stride - 1);
+    };
+    constexpr std::size_t prefetchDistance = 16;
+    for (std::size_t entry = 0; entry < std::min(n, prefetchDistance); ++entry) prefetch(chosen[entry]);
+    for (std::size_t entry = 0; entry < n; ++entry) {
+        if (entry + prefetchDistance < n) prefetch(chosen[entry + prefetchDistance]);
+        unpackSlot(store, *store.shards[chosen[entry].first], chosen[entry].second, batch, entry);
+    }
+    if (slots != nullptr) {
+        slots->resize(n);
+        for (std::size_t entry = 0; entry < n; ++entry) (*slots)[entry] = chosen[entry].first * store.shardCapacity + chosen[entry].second;
+    }
+}
+
+void replaySetPriority(ReplayStore& store, std::uint64_t slot, float priority) {
+    const std::size_t shard = static_cast<std::size_t>(slot / store.shardCapacity);
+    store.shards[shard]->priorities[static_cast<std::size_t>(slot % store.shardCapacity)].store(priority, std::memory_order_relaxed);
+    // Raise the maximum if needed; another thread may be raising it too
+    float seen = store.maxPriority.load(std::memory_order_relaxed);
+    while (priority > seen && !store.maxPriority.compare_exchange_weak(seen, priority, std::memory_order_relaxed)) {
+    }
+}
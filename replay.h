@@ -0,0 +1,94 @@
+#ifndef TICTACTOE_REPLAY_H
+#define TICTACTOE_REPLAY_H
+
+#include "mlp.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// PACKED REPLAY STORE
+//
+// Self-play produces training samples - a position, a move distribution, a
+// result - far faster than anyone looks at them individually, and training
+// reads them back in random order, thousands per second. Kept as a
+// position plus a std::vector<float> each, a sample is a heap allocation
+// of its own: ~150 bytes spread over two places in memory, and drawing a
+// batch is a pointer chase per sample.
+//
+// Here a sample is a few 64-bit WORDS in one flat array:
+//
+//   word 0       sequence number (see below)
+//   word 1, 2    X and O bitboards - the side to move follows from them
+//   word 3       Zobrist key, so that reading a sample computes nothing
+//   word 4       the value target (float bits) and the policy bytes' sum
+//   word 5 ...   the policy, one byte per cell (probability * 255), eight
+//                cells per word
+//
+// 7 words (56 bytes) for a 4x4 board, 9 for 5x5, 13 for 8x8. The store is
+// a RING: once full, each new sample overwrites the oldest.
+//
+// ONE WRITER PER SHARD, NO LOCKS. Each self-play thread appends to a shard
+// of its own, so appends never contend with each other. A trainer reading
+// a slot while its writer overwrites it is detected with a SEQUENCE LOCK:
+//
+//   writer:  sequence += 1 (odd: busy), write the words, sequence += 1
+//   reader:  read sequence, copy the words, read sequence again; if it was
+//            odd or has changed, the copy may be torn - copy again
+//
+// The words are std::atomic<uint64_t> used with relaxed loads and stores
+// (plain moves on x86) so that even a torn read is not a data race in C++
+// terms; fences order them against the sequence number. A shard's
+// 'written' counter is published after the slot, so readers never see a
+// slot that has not been written at least once.
+//
+// SAMPLING. Uniform: a random slot among the filled ones, shards weighted
+// by how full they are. PRIORITIZED: each slot also has a priority (a new
+// sample gets the largest seen so far, so it is drawn at least once soon),
+// and a uniformly drawn slot is ACCEPTED with probability
+// priority / max priority, otherwise drawn again - "stochastic acceptance",
+// exactly proportional sampling without a sum tree that the writers would
+// have to lock. Drawn samples are unpacked straight into a TrainingBatch:
+// contiguous arrays, ready for mlpTrainBatch.
+// ============================================================================
+
+enum class ReplaySampling { Uniform, Prioritized };
+
+struct ReplayShard {
+    std::vector<std::atomic<std::uint64_t>> words;   // [slot][stride]
+    std::vector<std::atomic<float>> priorities;      // [slot]
+    alignas(64) std::atomic<std::uint64_t> written{0};   // appends so far, on its own cache line
+};
+
+// Holds atomics and must stay where it is: create with makeReplayStore
+struct ReplayStore {
+    MnkRules rules;
+    int stride;                                      // words per slot
+    std::size_t shardCapacity;                       // slots per shard
+    std::vector<std::unique_ptr<ReplayShard>> shards;
+    std::atomic<float> maxPriority{1.0f};
+};
+
+// 'capacity' slots in total, split into one shard per writer
+std::unique_ptr<ReplayStore> makeReplayStore(const MnkRules& rules, std::size_t capacity, int writers);
+
+// Append a sample to shard 'writer': a position with a move still to play.
+// Only one thread may append to a given shard; any number may sample
+// meanwhile.
+void replayAppend(ReplayStore& store, int writer, const MnkState& state, const float* policy, float value);
+
+// Samples held now (at most the capacity), and samples ever appended
+std::size_t replaySize(const ReplayStore& store);
+std::uint64_t replayAppended(const ReplayStore& store);
+
+// Draw 'count' samples (with replacement) into 'batch', replacing its
+// contents. 'rng' is a splitmix64 counter. If 'slots' is given it receives
+// each sample's slot, for replaySetPriority. An empty store gives zeros.
+void replaySample(const ReplayStore& store, int count, ReplaySampling sampling, std::uint64_t& rng,
+                  TrainingBatch& batch, std::vector<std::uint64_t>* slots = nullptr);
+
+// Give a sampled slot a new priority (e.g. its training loss)
+void replaySetPriority(ReplayStore& store, std::uint64_t slot, float priority);
+
+#endif // TICTACTOE_REPLAY_H
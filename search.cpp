@@ -0,0 +1,600 @@
+#include "search.h"
+#include "workpool.h"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+// ============================================================================
+// std::thread AND std::atomic
+//
+// std::thread runs a function on another CPU core:
+//   std::thread t([&]() { work(); });   // starts running immediately
+//   t.join();                           // wait for it to finish
+//
+// Two threads touching the same ordinary variable at the same time (with at
+// least one writing) is a "data race" - undefined behavior. std::atomic<T>
+// makes individual loads and stores indivisible:
+//   std::atomic<bool> stop{false};
+//   stop.store(true);            // in one thread
+//   while (!stop.load()) {...}   // in another
+//
+// std::memory_order_relaxed asks only for that indivisibility, with no
+// ordering promises about OTHER variables. It is the cheapest option and all
+// that a stop flag or a self-checking table slot needs.
+// ============================================================================
+
+// ============================================================================
+// Transposition Table
+// ============================================================================
+
+// ============================================================================
+// mmap AND madvise
+//
+// operator new gets memory from the C++ runtime's heap. For a table of
+// hundreds of megabytes we go straight to the operating system instead:
+//
+//   mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+//     - maps 'bytes' of fresh zero-filled memory; MAP_HUGETLB asks for it to
+//       come from the reserved 2MB page pool
+//   madvise(address, bytes, MADV_HUGEPAGE)
+//     - a hint that this range should use transparent huge pages. Only
+//       ranges aligned to 2MB can use them, so we map 2MB extra and trim.
+//   munmap(address, bytes) - gives the memory back
+//
+// These are POSIX/Linux calls, so elsewhere we fall back to new[].
+// ============================================================================
+
+constexpr std::size_t hugePageSize = std::size_t{2} << 20;
+
+void TableMemoryDeleter::operator()(TableSlot* slots) const {
+#ifdef __linux__
+    if (bytes != 0) {
+        munmap(slots, bytes);
+        return;
+    }
+#endif
+    delete[] slots;
+}
+
+// Helper: map 'bytes' (a multiple of 2MB) using huge pages if possible.
+// Returns the address and the kind of pages, or nullptr if mmap failed.
+std::pair<void*, TablePages> mapLargePages(std::size_t bytes) {
+#ifdef __linux__
+    void* explicitPages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (explicitPages != MAP_FAILED) return {explicitPages, TablePages::Explicit};
+
+    // Over-map by one huge page, then unmap the unaligned head and tail
+    void* raw = mmap(nullptr, bytes + hugePageSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return {nullptr, TablePages::Normal};
+    const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (start + hugePageSize - 1) & ~(hugePageSize - 1);
+    if (aligned > start) munmap(raw, aligned - start);
+    if (start + hugePageSize > aligned) {
+        munmap(reinterpret_cast<void*>(aligned + bytes), start + hugePageSize - aligned);
+    }
+    void* address = reinterpret_cast<void*>(aligned);
+    return {address, madvise(address, bytes, MADV_HUGEPAGE) == 0 ? TablePages::Transparent
+                                                                 : TablePages::Normal};
+#else
+    (void)bytes;
+    return {nullptr, TablePages::Normal};
+#endif
+}
+
+TranspositionTable makeTable(std::size_t megabytes, bool largePages) {
+    // Largest power of two number of slots that fits (at least 1024)
+    std::size_t slots = 1024;
+    while (slots * 2 * sizeof(TableSlot) <= megabytes * 1024 * 1024) slots *= 2;
+    const std::size_t bytes = slots * sizeof(TableSlot);
+
+    const std::pair<void*, TablePages> mapped = (largePages && bytes >= hugePageSize)
+        ? mapLargePages(bytes)
+        : std::pair<void*, TablePages>{nullptr, TablePages::Normal};
+    if (mapped.first == nullptr) {
+        return TranspositionTable{
+            std::unique_ptr<TableSlot[], TableMemoryDeleter>(new TableSlot[slots], TableMemoryDeleter{}),
+            slots - 1, TablePages::Normal};
+    }
+    // Construct the atomics in the mapped memory (this also touches every
+    // page now, rather than in the middle of the first search)
+    TableSlot* first = static_cast<TableSlot*>(mapped.first);
+    std::for_each(first, first + slots, [](TableSlot& slot) { new (&slot) TableSlot; });
+    return TranspositionTable{
+        std::unique_ptr<TableSlot[], TableMemoryDeleter>(first, TableMemoryDeleter{bytes}),
+        slots - 1, mapped.second};
+}
+
+std::string tablePagesName(TablePages pages) {
+    return pages == TablePages::Explicit ? "explicit 2MB pages"
+         : pages == TablePages::Transparent ? "transparent 2MB pages"
+         : "4KB pages";
+}
+
+void tablePrefetch(const TranspositionTable& table, std::uint64_t key) {
+    __builtin_prefetch(&table.slots[key & table.mask]);
+}
+
+std::size_t tableSize(const TranspositionTable& table) {
+    return table.mask + 1;
+}
+
+std::uint64_t packEntry(const TableEntry& entry) {
+    return static_cast<std::uint64_t>(entry.score + 32768)
+         | static_cast<std::uint64_t>(entry.depth & 0xFF) << 16
+         | static_cast<std::uint64_t>(entry.bound) << 24
+         | static_cast<std::uint64_t>(entry.move + 1) << 32;
+}
+
+TableEntry unpackEntry(std::uint64_t data) {
+    return TableEntry{
+        static_cast<int>(data & 0xFFFF) - 32768,
+        static_cast<int>((data >> 16) & 0xFF),
+        static_cast<Bound>((data >> 24) & 0xFF),
+        static_cast<int>((data >> 32) & 0xFF) - 1};
+}
+
+std::optional<TableEntry> tableProbe(const TranspositionTable& table, std::uint64_t key) {
+    const TableSlot& slot = table.slots[key & table.mask];
+    const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+    // An all-zero (never written) slot passes the check for key 0, the empty
+    // board - the Bound::None test rejects it
+    return ((check ^ data) == key && unpackEntry(data).bound != Bound::None)
+        ? std::optional{unpackEntry(data)}
+        : std::nullopt;
+}
+
+void tableStore(TranspositionTable& table, std::uint64_t key, const TableEntry& entry) {
+    TableSlot& slot = table.slots[key & table.mask];
+    const std::uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+    const bool sameKey = (slot.check.load(std::memory_order_relaxed) ^ oldData) == key;
+    if (!sameKey || unpackEntry(oldData).depth <= entry.depth) {
+        const std::uint64_t data = packEntry(entry);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+    }
+}
+
+void tableClear(TranspositionTable& table) {
+    std::for_each(table.slots.get(), table.slots.get() + tableSize(table), [](TableSlot& slot) {
+        slot.check.store(0, std::memory_order_relaxed);
+        slot.data.store(0, std::memory_order_relaxed);
+    });
+}
+
+int scoreToTable(int score, int ply) {
+    return score > winThreshold ? score + ply : score < -winThreshold ? score - ply : score;
+}
+
+int scoreFromTable(int score, int ply) {
+    return score > winThreshold ? score - ply : score < -winThreshold ? score + ply : score;
+}
+
+// ============================================================================
+// Alpha-Beta Search
+//
+// Search is the one place in this codebase where we deliberately keep some
+// mutable state: a per-thread SearchContext counts nodes and watches the
+// clock. Positions themselves are still immutable values - every child is a
+// new MnkState, and "undo" is simply returning to the parent's variable.
+// ============================================================================
+
+using Clock = std::chrono::steady_clock;
+
+struct SearchContext {
+    const MnkRules& rules;
+    TranspositionTable& table;
+    std::atomic<bool>& stop;
+    const PatternEval& patterns;
+    std::array<int, maxCells> order;   // this thread's preferred move order
+    bool isMain;                       // only the main thread watches the clock
+    bool timed;
+    Clock::time_point deadline;
+    bool useKillers;
+    bool useHistory;
+    LeafEval leafEval;
+    std::uint64_t nodes = 0;
+    int rootMove = -1;
+    const std::atomic<bool>* cancel = nullptr;   // external stop request, watched by the main thread
+    // YBWC only: the pool, every worker's context (indexed by worker), and
+    // the task group this worker is currently searching for
+    WorkPool* pool = nullptr;
+    std::vector<SearchContext>* workers = nullptr;
+    int worker = 0;
+    int splitDepth = 0;
+    const TaskGroup* group = nullptr;
+    std::array<std::array<int, 2>, maxCells + 1> killers{};      // [ply][slot], -1 = none
+    std::array<std::array<std::int32_t, maxCells>, 2> history{};  // [player][cell]
+    // LeafEval::Network only: the net, and the accumulator of the position
+    // being searched - updated on the way into a child and back out of it
+    const QuantNet* network = nullptr;
+    NnueAccumulator accumulator{};
+};
+
+// Helper: cells ordered centre-first (central cells take part in more lines).
+// 'noise' > 0 perturbs the order differently for every seed - that is what
+// makes Lazy SMP helper threads explore the tree in different orders.
+std::array<int, maxCells> moveOrder(const MnkRules& rules, std::uint64_t seed, int noise) {
+    std::array<int, maxCells> distance{};
+    std::array<int, maxCells> order{};
+    for (int c = 0; c < rules.cells; ++c) {
+        const int dr = 2 * (c / rules.cols) - (rules.rows - 1);
+        const int dc = 2 * (c % rules.cols) - (rules.cols - 1);
+        distance[c] = 4 * (dr * dr + dc * dc)
+                    + (noise > 0 ? static_cast<int>(splitMix64(seed * maxCells + c) % noise) : 0);
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.begin() + rules.cells,
+        [&](int a, int b) { return distance[a] < distance[b]; });
+    return order;
+}
+
+// Helper: empty cells in search order - table move, killers, then the rest
+// by history score (ties in the thread's preferred order).
+// Returns the number of moves written to 'moves'.
+int orderedMoves(const SearchContext& ctx, const MnkState& state, int ttMove, int ply,
+                 std::array<int, maxCells>& moves) {
+    Bitboard remaining = emptyCells(ctx.rules, state);
+    int n = 0;
+    const auto take = [&](int cell) {
+        if (cell >= 0 && ((remaining >> cell) & 1)) {
+            moves[n++] = cell;
+            remaining &= ~(Bitboard{1} << cell);
+        }
+    };
+    take(ttMove);
+    if (ctx.useKillers) {
+        take(ctx.killers[ply][0]);
+        take(ctx.killers[ply][1]);
+    }
+    const int quiet = n;
+    for (int i = 0; i < ctx.rules.cells; ++i) take(ctx.order[i]);
+    if (ctx.useHistory) {
+        const std::array<std::int32_t, maxCells>& scores = ctx.history[playerIndex(state.toMove)];
+        std::stable_sort(moves.begin() + quiet, moves.begin() + n,
+            [&](int a, int b) { return scores[a] > scores[b]; });
+    }
+    return n;
+}
+
+// Helper: remember a move that caused a beta cutoff
+void recordCutoff(SearchContext& ctx, const MnkState& state, int move, int depth, int ply) {
+    if (ctx.killers[ply][0] != move) {
+        ctx.killers[ply][1] = ctx.killers[ply][0];
+        ctx.killers[ply][0] = move;
+    }
+    std::int32_t& score = ctx.history[playerIndex(state.toMove)][move];
+    score += depth * depth;
+    // Keep scores bounded (and let old knowledge fade) by halving them all
+    if (score > (1 << 24)) {
+        for (auto& player : ctx.history) {
+            std::for_each(player.begin(), player.end(), [](std::int32_t& h) { h /= 2; });
+        }
+    }
+}
+
+// Helper: score of a position at the depth limit, for the side to move.
+// 'eval' is the incrementally maintained evaluation (from X's side).
+int leafScore(const SearchContext& ctx, const MnkState& state, int eval) {
+    if (ctx.leafEval == LeafEval::Network) {
+        return std::clamp(nnueScore(*ctx.network, ctx.accumulator, state.toMove), -maxEvalScore, maxEvalScore);
+    }
+    const int forX = ctx.leafEval == LeafEval::Full
+        ? patternEvaluate(ctx.rules, ctx.patterns, state.x, state.o)
+        : eval;
+    return std::clamp(state.toMove == Cell::X ? forX : -forX, -maxEvalScore, maxEvalScore);
+}
+
+// Helper: should this search give up? Either time is up, or (YBWC) some
+// node above us already got a cutoff and cancelled our task group.
+bool stopped(const SearchContext& ctx) {
+    return ctx.stop.load(std::memory_order_relaxed) || taskGroupCancelled(ctx.group);
+}
+
+int negamax(SearchContext& ctx, const MnkState& state, int eval, int depth, int alpha, int beta, int ply);
+
+// Helper: play 'cell' and search the child, returning its score for us
+int searchChild(SearchContext& ctx, const MnkState& state, int eval, int cell,
+                int depth, int alpha, int beta, int ply) {
+    const MnkState child = mnkPlay(ctx.rules, state, cell);
+    // Start fetching the child's slot now; by the time the child probes
+    // it (after its own terminal checks) the cache miss is under way
+    tablePrefetch(ctx.table, child.key);
+    const int childEval = ctx.leafEval == LeafEval::Incremental
+        ? eval + patternDelta(ctx.rules, ctx.patterns, state, cell)
+        : 0;
+    if (ctx.leafEval != LeafEval::Network) return -negamax(ctx, child, childEval, depth - 1, -beta, -alpha, ply + 1);
+
+    nnueAdd(*ctx.network, ctx.accumulator, state.toMove, cell);
+    const int score = -negamax(ctx, child, childEval, depth - 1, -beta, -alpha, ply + 1);
+    nnueRemove(*ctx.network, ctx.accumulator, state.toMove, cell);
+    return score;
+}
+
+// ============================================================================
+// YOUNG BROTHERS WAIT (YBWC)
+//
+// The other way to search in parallel: split the TREE between threads. At a
+// node, the first child (the "eldest brother") is searched alone. If it
+// causes a cutoff, the other children are never needed - searching them in
+// parallel would have been wasted work. Only if it doesn't are the younger
+// brothers handed to the work-stealing pool, all at once.
+//
+// Every sibling task reads the node's CURRENT alpha when it starts, so a
+// good score found by one sibling narrows the windows of those that start
+// later. A sibling that reaches beta cancels the node's task group; the
+// cancellation reaches every task spawned below it, wherever it is running.
+//
+// Positions are immutable values, so handing a sibling to another thread
+// needs no copying of board state and no locking - only the node's running
+// best score is shared, behind a mutex.
+// ============================================================================
+
+struct SplitPoint {
+    TaskGroup group;
+    std::mutex lock;     // guards the fields below
+    int alpha;
+    int best;
+    int bestMove;
+};
+
+// Helper: search moves[1..n) in parallel. alpha, best and bestMove come in
+// holding the eldest brother's result and go out holding the node's.
+void searchSiblings(SearchContext& ctx, const MnkState& state, int eval, int depth, int beta, int ply,
+                    const std::array<int, maxCells>& moves, int n, int& alpha, int& best, int& bestMove) {
+    SplitPoint split;
+    split.group.parent = ctx.group;
+    split.alpha = alpha;
+    split.best = best;
+    split.bestMove = bestMove;
+
+    // Spawn in reverse: we pop our own deque from the back, so we search the
+    // best-ordered brothers first while thieves take the worst from the front
+    std::vector<SearchContext>& workers = *ctx.workers;
+    for (int i = n - 1; i >= 1; --i) {
+        workSpawn(*ctx.pool, ctx.worker, split.group, [&, cell = moves[i]](int worker) {
+            SearchContext& wctx = workers[worker];
+            // The worker may be in the middle of waiting on its own split
+            // point (and running us to help out): restore its group after
+            const TaskGroup* outer = wctx.group;
+            wctx.group = &split.group;
+            // ...and likewise its accumulator, which belongs to its own node
+            const bool network = wctx.leafEval == LeafEval::Network;
+            NnueAccumulator outerAccumulator;
+            if (network) {
+                outerAccumulator = wctx.accumulator;
+                nnueRefresh(*wctx.network, wctx.accumulator, state);
+            }
+            int a;
+            {
+                const std::lock_guard<std::mutex> guard(split.lock);
+                a = split.alpha;
+            }
+            if (!stopped(wctx) && a < beta) {
+                const int score = searchChild(wctx, state, eval, cell, depth, a, beta, ply);
+                if (!stopped(wctx)) {
+                    const std::lock_guard<std::mutex> guard(split.lock);
+                    if (score > split.best) {
+                        split.best = score;
+                        split.bestMove = cell;
+                    }
+                    split.alpha = std::max(split.alpha, score);
+                    if (split.alpha >= beta) {
+                        recordCutoff(wctx, state, cell, depth, ply);
+                        taskGroupCancel(split.group);
+                    }
+                }
+            }
+            wctx.group = outer;
+            if (network) wctx.accumulator = outerAccumulator;
+        });
+    }
+    workWait(*ctx.pool, ctx.worker, split.group);
+
+    alpha = split.alpha;
+    best = split.best;
+    bestMove = split.bestMove;
+}
+
+// 'eval' is the pattern evaluation of 'state' from X's point of view; each
+// child gets it updated from the lines through the move (0 when unused)
+int negamax(SearchContext& ctx, const MnkState& state, int eval, int depth, int alpha, int beta, int ply) {
+    if ((++ctx.nodes & 4095) == 0 && ctx.isMain &&
+        ((ctx.timed && Clock::now() >= ctx.deadline) ||
+         (ctx.cancel != nullptr && ctx.cancel->load(std::memory_order_relaxed)))) {
+        ctx.stop.store(true, std::memory_order_relaxed);
+    }
+    if (stopped(ctx)) return 0;
+
+    // The previous move won: the side to move has lost
+    if (state.winner != Cell::Empty) return -(winScore - ply);
+    if (state.moves == ctx.rules.cells) return 0;
+    if (depth == 0) return leafScore(ctx, state, eval);
+
+    const int alphaOrig = alpha;
+    int ttMove = -1;
+    if (std::optional<TableEntry> entry = tableProbe(ctx.table, state.key)) {
+        ttMove = entry->move;
+        const int score = scoreFromTable(entry->score, ply);
+        // Never cut at the root: we need to know which move is best there
+        if (ply > 0 && entry->depth >= depth &&
+            (entry->bound == Bound::Exact ||
+             (entry->bound == Bound::Lower && score >= beta) ||
+             (entry->bound == Bound::Upper && score <= alpha))) {
+            return score;
+        }
+    }
+
+    std::array<int, maxCells> moves;
+    const int n = orderedMoves(ctx, state, ttMove, ply, moves);
+    int best = -infinityScore;
+    int bestMove = -1;
+    for (int i = 0; i < n && alpha < beta; ++i) {
+        if (i == 1 && ctx.pool != nullptr && depth >= ctx.splitDepth) {
+            // The eldest brother didn't cut off: the young brothers go parallel
+            searchSiblings(ctx, state, eval, depth, beta, ply, moves, n, alpha, best, bestMove);
+            if (stopped(ctx)) return 0;
+            if (ply == 0) ctx.rootMove = bestMove;
+            break;
+        }
+        const int score = searchChild(ctx, state, eval, moves[i], depth, alpha, beta, ply);
+        if (stopped(ctx)) return 0;
+        if (score > best) {
+            best = score;
+            bestMove = moves[i];
+            if (ply == 0) ctx.rootMove = bestMove;
+        }
+        alpha = std::max(alpha, score);
+        if (alpha >= beta) recordCutoff(ctx, state, moves[i], depth, ply);
+    }
+
+    tableStore(ctx.table, state.key, TableEntry{
+        scoreToTable(best, ply), depth,
+        best <= alphaOrig ? Bound::Upper : best >= beta ? Bound::Lower : Bound::Exact,
+        bestMove});
+    return best;
+}
+
+// Helper: one root search with the window (alpha, beta). A search that
+// fails low proves every move is <= alpha, so the move it leaves in rootMove
+// is just the least bad of the failures: keep the previous one instead.
+int rootSearch(SearchContext& ctx, const MnkState& state, int depth, int alpha, int beta, int& passes) {
+    const int previousMove = ctx.rootMove;
+    const int eval = ctx.leafEval == LeafEval::Incremental
+        ? patternEvaluate(ctx.rules, ctx.patterns, state.x, state.o)
+        : 0;
+    if (ctx.leafEval == LeafEval::Network) nnueRefresh(*ctx.network, ctx.accumulator, state);
+    const int score = negamax(ctx, state, eval, depth, alpha, beta, 0);
+    ++passes;
+    if (score <= alpha && previousMove >= 0) ctx.rootMove = previousMove;
+    return score;
+}
+
+// Helper: aspiration windows. Each failure widens the failing side four
+// times over, so a badly wrong guess costs a few re-searches, not many.
+int aspirationSearch(SearchContext& ctx, const MnkState& state, int depth, int guess,
+                     int window, int& passes) {
+    int alpha = std::max(guess - window, -infinityScore);
+    int beta = std::min(guess + window, infinityScore);
+    for (;;) {
+        const int score = rootSearch(ctx, state, depth, alpha, beta, passes);
+        if (ctx.stop.load(std::memory_order_relaxed)) return score;
+        window *= 4;
+        if (score <= alpha) alpha = std::max(score - window, -infinityScore);
+        else if (score >= beta) beta = std::min(score + window, infinityScore);
+        else return score;
+    }
+}
+
+// Helper: MTD(f). 'lower' and 'upper' bracket the true score; every
+// zero-window search around the current guess g moves one of them to g.
+int mtdfSearch(SearchContext& ctx, const MnkState& state, int depth, int guess, int& passes) {
+    int g = guess;
+    int lower = -infinityScore;
+    int upper = infinityScore;
+    while (lower < upper) {
+        const int beta = std::max(g, lower + 1);
+        g = rootSearch(ctx, state, depth, beta - 1, beta, passes);
+        if (ctx.stop.load(std::memory_order_relaxed)) break;
+        (g < beta ? upper : lower) = g;
+    }
+    return g;
+}
+
+// Helper: iterative deepening - search depth 1, 2, 3, ... Each iteration is
+// cheap compared to the next, and fills the table with best moves that make
+// the next iteration's move ordering (and so its pruning) much better. It
+// also supplies the guess the aspiration and MTD(f) drivers start from.
+SearchResult iterativeDeepening(SearchContext& ctx, const MnkState& state,
+                                const SearchLimits& limits, int firstDepth) {
+    SearchResult result;
+    int passes = 0;
+    const int exactDepth = ctx.rules.cells - state.moves;
+    for (int depth = firstDepth; depth <= std::min(limits.maxDepth, exactDepth); ++depth) {
+        const bool guessed = depth > firstDepth;
+        const int score =
+            limits.driver == RootDriver::Mtdf ? mtdfSearch(ctx, state, depth, result.score, passes)
+          : limits.driver == RootDriver::Aspiration && guessed
+              ? aspirationSearch(ctx, state, depth, result.score, std::max(1, limits.aspirationWindow), passes)
+          : rootSearch(ctx, state, depth, -infinityScore, infinityScore, passes);
+        if (ctx.stop.load(std::memory_order_relaxed)) break;
+        result = SearchResult{ctx.rootMove, score, depth, 0, passes};
+        // A proven win or loss won't change with more depth
+        if (score > winThreshold || score < -winThreshold) break;
+    }
+    return result;
+}
+
+SearchResult searchPosition(const MnkRules& rules, const MnkState& state,
+                            TranspositionTable& table, const SearchLimits& limits) {
+    if (mnkIsGameOver(rules, state)) return SearchResult{};
+
+    std::atomic<bool> stop{false};
+    const Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(limits.maxSeconds));
+
+    // One context per thread: nothing in here is shared except the table
+    // and the stop flag. YBWC threads split one tree, so they all keep the
+    // plain move order; Lazy SMP helpers need theirs perturbed.
+    const bool ybwc = limits.parallel == ParallelMode::Ybwc && limits.threads > 1;
+    const PatternEval patterns = makePatternEval(rules);
+    // A missing net, or one trained for other rules (its rows would be
+    // indexed by the wrong cells), falls back to the pattern evaluation
+    const bool networkFits = limits.network && limits.network->rules.rows == rules.rows &&
+                             limits.network->rules.cols == rules.cols && limits.network->rules.k == rules.k;
+    const LeafEval leafEval = limits.leafEval == LeafEval::Network && !networkFits
+        ? LeafEval::Incremental : limits.leafEval;
+    std::vector<SearchContext> contexts;
+    for (int i = 0; i < std::max(1, limits.threads); ++i) {
+        contexts.push_back(SearchContext{rules, table, stop, patterns,
+            moveOrder(rules, static_cast<std::uint64_t>(i), i == 0 || ybwc ? 0 : 6),
+            i == 0, limits.maxSeconds > 0.0, deadline, limits.killerMoves, limits.history,
+            leafEval});
+        contexts.back().killers.fill({-1, -1});
+        contexts.back().cancel = limits.cancel;
+        contexts.back().network = networkFits ? limits.network.get() : nullptr;
+    }
+
+    // YBWC: the pool's workers wait for sibling tasks; this thread is
+    // worker 0 and drives the iterations
+    const std::unique_ptr<WorkPool> pool = ybwc ? startWorkPool(static_cast<int>(contexts.size())) : nullptr;
+    for (std::size_t i = 0; ybwc && i < contexts.size(); ++i) {
+        contexts[i].pool = pool.get();
+        contexts[i].workers = &contexts;
+        contexts[i].worker = static_cast<int>(i);
+        contexts[i].splitDepth = std::max(1, limits.splitDepth);
+    }
+
+    // Lazy SMP: helpers start at alternating depths so they don't all
+    // duplicate the main thread's current iteration
+    std::vector<std::thread> helpers;
+    for (std::size_t i = 1; !ybwc && i < contexts.size(); ++i) {
+        helpers.emplace_back([&, i]() {
+            iterativeDeepening(contexts[i], state, limits, 1 + static_cast<int>(i % 2));
+        });
+    }
+
+    SearchResult result = iterativeDeepening(contexts[0], state, limits, 1);
+    stop.store(true, std::memory_order_relaxed);
+    std::for_each(helpers.begin(), helpers.end(), [](std::thread& t) { t.join(); });
+    if (pool) stopWorkPool(*pool);
+
+    // Out of time before depth 1 finished: any legal move beats none
+    result.move = result.move >= 0 ? result.move : __builtin_ctzll(emptyCells(rules, state));
+    for (const SearchContext& ctx : contexts) result.nodes += ctx.nodes;
+    return result;
+}
+
+MnkStrategy searchStrategy(std::shared_ptr<TranspositionTable> table, SearchLimits limits) {
+    return [table, limits](const MnkRules& rules, const MnkState& state) {
+        return searchPosition(rules, state, *table, limits).move;
+    };
+}
@@ -0,0 +1,251 @@
+#ifndef TICTACTOE_SEARCH_H
+#define TICTACTOE_SEARCH_H
+
+#include "mnk.h"
+#include "eval.h"
+#include "nnue.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// ============================================================================
+// GAME TREE SEARCH
+//
+// Minimax with alpha-beta pruning, written in NEGAMAX form: every score is
+// from the point of view of the side to move, so "my best score" is always
+// the maximum of "minus the opponent's best score" over my moves.
+//
+// Scores:
+//   winScore - ply     the side to move wins, ply moves from the root
+//   0                  draw
+//   |score| <= maxEvalScore  the pattern evaluation, at the depth limit
+//   -(winScore - ply)  the side to move loses
+//
+// Subtracting the ply makes the search prefer FASTER wins and SLOWER losses.
+// ============================================================================
+
+constexpr int winScore = 10000;
+constexpr int infinityScore = 32000;
+
+// Any score above this is a forced win (below its negative, a forced loss)
+constexpr int winThreshold = winScore - maxCells - 1;
+
+// Evaluations are clamped well clear of the win scores
+constexpr int maxEvalScore = winThreshold / 2;
+
+// ============================================================================
+// TRANSPOSITION TABLE
+//
+// Different move orders reach the same position, so the search tree contains
+// the same subtree many times. A transposition table remembers what we found
+// out about a position (keyed by its Zobrist key) so we don't search it again.
+//
+// What we remember is often a BOUND, not an exact score, because alpha-beta
+// stops searching a node as soon as it knows the node won't be chosen:
+//   Exact - the true score (at that depth)
+//   Lower - the score is at least this (we stopped after a "too good" move)
+//   Upper - the score is at most this (no move reached alpha)
+// ============================================================================
+enum class Bound : std::uint8_t { None, Exact, Lower, Upper };
+
+// One remembered search result
+struct TableEntry {
+    int score;    // stored relative to THIS node (see scoreToTable)
+    int depth;    // remaining depth the result was searched to
+    Bound bound;
+    int move;     // best move found, or -1
+};
+
+// ============================================================================
+// LOCK-FREE SHARING BETWEEN THREADS
+//
+// Several search threads read and write the same table at the same time.
+// Guarding every slot with a mutex would make the table the bottleneck, so
+// each slot is two 64-bit std::atomic words instead:
+//
+//   data  = the entry packed into 64 bits
+//   check = key ^ data
+//
+// A std::atomic<uint64_t> load or store can never be seen half-written. But
+// two threads writing the same slot can still interleave their two stores,
+// leaving "check" from one write and "data" from the other. The XOR catches
+// that: a reader accepts the slot only if check ^ data == the key it wants,
+// which a torn pair fails (with overwhelming probability). A rare bad entry
+// costs a little search quality, never memory safety.
+//
+// This is the "lockless hashing" trick from Hyatt and Mann's chess programs.
+// ============================================================================
+struct TableSlot {
+    std::atomic<std::uint64_t> check{0};
+    std::atomic<std::uint64_t> data{0};
+};
+
+// ============================================================================
+// LARGE PAGES
+//
+// The CPU translates every virtual address to a physical one, and caches the
+// translations in a small "TLB". With ordinary 4KB pages a 1GB table needs
+// 262,144 translations - far more than the TLB holds - so a random table
+// probe usually pays for a TLB miss AND a cache miss. With 2MB pages the
+// same table needs only 512 translations.
+//
+// Linux offers two ways to get them:
+//   Explicit    - mmap(MAP_HUGETLB): pages reserved by the administrator
+//                 (/proc/sys/vm/nr_hugepages). Guaranteed, but usually 0.
+//   Transparent - ordinary memory plus madvise(MADV_HUGEPAGE): the kernel
+//                 uses 2MB pages when it can.
+// If neither is available the table silently uses normal pages.
+// ============================================================================
+enum class TablePages { Normal, Transparent, Explicit };
+
+// Releases table memory the same way it was obtained (munmap or delete[])
+struct TableMemoryDeleter {
+    std::size_t bytes = 0;   // mapped length, 0 if allocated with new[]
+    void operator()(TableSlot* slots) const;
+};
+
+// Shared transposition table. Create with makeTable(); share between threads
+// by reference. Not copyable (it owns the slots).
+struct TranspositionTable {
+    std::unique_ptr<TableSlot[], TableMemoryDeleter> slots;
+    std::size_t mask;    // slot count - 1 (slot count is a power of two)
+    TablePages pages;    // what kind of pages back the slots
+};
+
+// Create a table using about 'megabytes' of memory (rounded down to a power
+// of two). Tables of 2MB or more try huge pages unless largePages is false.
+TranspositionTable makeTable(std::size_t megabytes, bool largePages = true);
+
+// Display name of a TablePages value
+std::string tablePagesName(TablePages pages);
+
+// Ask the CPU to start loading the slot for 'key' into cache. Returns
+// immediately; a probe issued a little later then finds the data waiting.
+void tablePrefetch(const TranspositionTable& table, std::uint64_t key);
+
+// Number of slots
+std::size_t tableSize(const TranspositionTable& table);
+
+// Look up a position; nullopt if it isn't stored (or the slot was torn)
+std::optional<TableEntry> tableProbe(const TranspositionTable& table, std::uint64_t key);
+
+// Store a search result (always replaces, except a deeper result for the same key)
+void tableStore(TranspositionTable& table, std::uint64_t key, const TableEntry& entry);
+
+// Empty the table (not safe while a search is using it)
+void tableClear(TranspositionTable& table);
+
+// Pack / unpack an entry into one 64-bit word
+std::uint64_t packEntry(const TableEntry& entry);
+TableEntry unpackEntry(std::uint64_t data);
+
+// Win/loss scores count plies from the ROOT, but a stored position can be
+// reached at a different ply next time. Convert to "plies from this node"
+// when storing and back when probing.
+int scoreToTable(int score, int ply);
+int scoreFromTable(int score, int ply);
+
+// ============================================================================
+// Search
+// ============================================================================
+
+// ============================================================================
+// ROOT DRIVERS
+//
+// Alpha-beta prunes everything that falls outside its (alpha, beta) window,
+// so a NARROW window prunes more. The root of each iteration can be searched
+// three ways:
+//
+//   FullWindow  - (-infinity, +infinity). Always gives the exact score.
+//   Aspiration  - a small window around the previous iteration's score. If
+//                 the true score lands outside it ("fails low/high") the
+//                 search tells us which side, and we widen and search again.
+//   Mtdf        - MTD(f): nothing but ZERO-WINDOW searches (beta - 1, beta),
+//                 each of which only answers "is the score >= beta?". Every
+//                 answer moves an upper or lower bound until they meet. The
+//                 re-searches are cheap because the transposition table
+//                 remembers the bounds found by the previous ones.
+//
+// Both pay off when scores change little between iterations - here they
+// are mostly draws (0) or wins, so the first guess is usually right.
+// ============================================================================
+
+enum class RootDriver { FullWindow, Aspiration, Mtdf };
+
+// What a leaf at the depth limit is worth (see eval.h):
+//   None        - 0, "unknown"
+//   Full        - pattern evaluation recomputed from the whole board
+//   Incremental - pattern evaluation carried down the tree, move by move
+//   Network     - limits.network's value head, its accumulator updated
+//                 move by move (see nnue.h); Incremental if there is no network
+enum class LeafEval { None, Full, Incremental, Network };
+
+// How limits.threads > 1 threads share the work (see searchPosition)
+enum class ParallelMode { LazySmp, Ybwc };
+
+struct SearchLimits {
+    int maxDepth = maxCells;   // plies; a search as deep as the empty cells is exact
+    int threads = 1;           // Lazy SMP threads (including the main one)
+    double maxSeconds = 0.0;   // 0 = no time limit
+    bool killerMoves = true;   // try moves that caused cutoffs at the same ply early
+    bool history = false;      // order the remaining moves by history score (see MOVE ORDERING)
+    RootDriver driver = RootDriver::FullWindow;
+    int aspirationWindow = 25; // half-width of the first aspiration window
+    LeafEval leafEval = LeafEval::Incremental;
+    ParallelMode parallel = ParallelMode::LazySmp;
+    int splitDepth = 6;        // YBWC: nodes with less depth left are searched serially
+    const std::atomic<bool>* cancel = nullptr;           // another thread sets it to stop the search
+    std::shared_ptr<const QuantNet> network = nullptr;   // for LeafEval::Network; ignored unless its rules match
+};
+
+struct SearchResult {
+    int move = -1;             // best move (-1 if the game is over)
+    int score = 0;             // from the side to move's point of view
+    int depth = 0;             // deepest fully completed iteration
+    std::uint64_t nodes = 0;   // positions visited by all threads
+    int passes = 0;            // root searches by the main thread, re-searches included
+};
+
+// ============================================================================
+// MOVE ORDERING
+//
+// Alpha-beta prunes the most when the best move is searched FIRST: with
+// perfect ordering it visits about the square root of the nodes plain
+// minimax would. The search tries moves in this order:
+//
+//   1. The transposition table move - best move from an earlier search
+//   2. Killer moves - the last two moves that caused a cutoff at this same
+//      ply somewhere else in the tree. Positions at the same ply tend to be
+//      similar, so a refutation in one is often a refutation in its siblings.
+//   3. Everything else, by HISTORY score: history[player][cell] grows by
+//      depth * depth every time that cell caused a cutoff for that player,
+//      anywhere in the tree. It learns which cells matter on this board.
+//      Ties keep the centre-first order.
+//
+// History ordering is OFF by default (SearchLimits::history). Measured again
+// with the pattern leaf evaluation in place (bench move-ordering, killers
+// on), it saves nodes only on 4x4 k=4 (-16%) and costs them or time
+// elsewhere: 5x5 k=4 depth 10 visits 29% more nodes in twice the time, and
+// 6x6 and 7x7 stay level in nodes but run slower for the sorting. Killers
+// alone already catch most of what it learns.
+// ============================================================================
+
+// Iterative-deepening alpha-beta from 'state' using 'table'.
+//
+// LAZY SMP: with limits.threads > 1, helper threads search the same position
+// at the same time, each trying moves in a different order. They don't talk
+// to each other at all - except through the shared table, where every thread
+// finds bounds and best moves that the others already worked out. The main
+// thread's answer is the one returned.
+//
+// YBWC (limits.parallel = Ybwc): the threads split ONE tree instead - see
+// search.cpp. The result does not depend on which thread searched what,
+// except through the order entries reach the shared table.
+SearchResult searchPosition(const MnkRules& rules, const MnkState& state,
+                            TranspositionTable& table, const SearchLimits& limits);
+
+// Strategy that searches with a table shared across all its moves (and threads)
+MnkStrategy searchStrategy(std::shared_ptr<TranspositionTable> table, SearchLimits limits);
+
+#endif // TICTACTOE_SEARCH_H
@@ -0,0 +1,292 @@
+#include "tablebase.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// Binomial Coefficients
+//
+// Pascal's triangle, built at compile time: C(n, k) = C(n-1, k-1) + C(n-1, k).
+// C(64, 32) is about 1.8e18, which still fits in 64 bits.
+// ============================================================================
+
+constexpr std::array<std::array<std::uint64_t, maxCells + 1>, maxCells + 1> makeBinomials() {
+    std::array<std::array<std::uint64_t, maxCells + 1>, maxCells + 1> c{};
+    for (int n = 0; n <= maxCells; ++n) {
+        c[n][0] = 1;
+        for (int k = 1; k <= n; ++k) c[n][k] = c[n - 1][k - 1] + c[n - 1][k];
+    }
+    return c;
+}
+
+constexpr auto binomial = makeBinomials();
+
+// ============================================================================
+// Ranking
+// ============================================================================
+
+// Helper: combinatorial-number-system rank of the set bits of 'subset'
+std::uint64_t subsetRank(Bitboard subset) {
+    std::uint64_t rank = 0;
+    for (int i = 1; subset != 0; subset &= subset - 1, ++i) {
+        rank += binomial[__builtin_ctzll(subset)][i];
+    }
+    return rank;
+}
+
+// Helper: the m-element subset of {0 .. universe-1} with the given rank
+Bitboard subsetUnrank(std::uint64_t rank, int m, int universe) {
+    Bitboard subset = 0;
+    int c = universe;
+    for (int i = m; i >= 1; --i) {
+        do { --c; } while (binomial[c][i] > rank);
+        subset |= Bitboard{1} << c;
+        rank -= binomial[c][i];
+    }
+    return subset;
+}
+
+// Helper: squeeze the bits of 'bits' that lie inside 'mask' together
+// (bit j of the result = bit of 'bits' at the j-th set cell of 'mask')
+Bitboard compressBits(Bitboard bits, Bitboard mask) {
+    Bitboard out = 0;
+    for (int j = 0; mask != 0; mask &= mask - 1, ++j) {
+        out |= ((bits >> __builtin_ctzll(mask)) & 1) << j;
+    }
+    return out;
+}
+
+// Helper: the inverse of compressBits
+Bitboard expandBits(Bitboard packed, Bitboard mask) {
+    Bitboard out = 0;
+    for (int j = 0; mask != 0; mask &= mask - 1, ++j) {
+        out |= ((packed >> j) & 1) << __builtin_ctzll(mask);
+    }
+    return out;
+}
+
+// Helper: positions with exactly n pieces
+std::uint64_t layerSize(int cells, int pieces) {
+    return binomial[cells][pieces] * binomial[pieces][pieces / 2];
+}
+
+std::uint64_t layerOffset(int cells, int pieces) {
+    std::uint64_t offset = 0;
+    for (int n = 0; n < pieces; ++n) offset += layerSize(cells, n);
+    return offset;
+}
+
+std::uint64_t rankedPositionCount(int cells) {
+    return layerOffset(cells, cells + 1);
+}
+
+// Helper: rank with the layer offsets already looked up (the solver's hot path)
+std::uint64_t rankWithOffsets(const std::vector<std::uint64_t>& offsets, Bitboard x, Bitboard o) {
+    const Bitboard occupied = x | o;
+    const int n = __builtin_popcountll(occupied);
+    return offsets[n] + subsetRank(occupied) * binomial[n][n / 2] + subsetRank(compressBits(o, occupied));
+}
+
+// Helper: layerOffset for every piece count 0 .. cells + 1
+std::vector<std::uint64_t> layerOffsets(int cells) {
+    std::vector<std::uint64_t> offsets;
+    for (int n = 0; n <= cells + 1; ++n) offsets.push_back(layerOffset(cells, n));
+    return offsets;
+}
+
+std::uint64_t positionRank(int cells, Bitboard x, Bitboard o) {
+    return layerOffset(cells, __builtin_popcountll(x | o))
+         + subsetRank(x | o) * binomial[__builtin_popcountll(x | o)][__builtin_popcountll(x | o) / 2]
+         + subsetRank(compressBits(o, x | o));
+}
+
+std::pair<Bitboard, Bitboard> positionUnrank(int cells, std::uint64_t rank) {
+    int n = 0;
+    while (rank >= layerSize(cells, n)) rank -= layerSize(cells, n++);
+    const std::uint64_t oChoices = binomial[n][n / 2];
+    const Bitboard occupied = subsetUnrank(rank / oChoices, n, cells);
+    const Bitboard o = expandBits(subsetUnrank(rank % oChoices, n / 2, n), occupied);
+    return {occupied & ~o, o};
+}
+
+// ============================================================================
+// Values
+// ============================================================================
+
+std::uint8_t packValue(PositionValue value) {
+    return static_cast<std::uint8_t>(static_cast<int>(value.outcome) << 6 | (value.plies & 0x3F));
+}
+
+PositionValue unpackValue(std::uint8_t byte) {
+    return PositionValue{static_cast<Outcome>(byte >> 6), byte & 0x3F};
+}
+
+// ============================================================================
+// Retrograde Solver
+// ============================================================================
+
+// Helper: does 'pieces' contain a complete line?
+bool hasLine(const MnkRules& rules, Bitboard pieces) {
+    return std::any_of(rules.lines.begin(), rules.lines.end(),
+        [&](Bitboard line) { return (pieces & line) == line; });
+}
+
+// Helper: value of one position, given the values of the next layer
+PositionValue solvePosition(const MnkRules& rules, const std::vector<std::uint64_t>& offsets,
+                            const std::uint8_t* values, Bitboard x, Bitboard o) {
+    const bool xToMove = __builtin_popcountll(x) == __builtin_popcountll(o);
+    const Bitboard own = xToMove ? x : o;
+    const Bitboard opponent = xToMove ? o : x;
+    if (hasLine(rules, own)) return PositionValue{Outcome::Illegal, 0};
+    if (hasLine(rules, opponent)) return PositionValue{Outcome::Loss, 0};
+
+    bool canDraw = false;
+    int fastestWin = maxCells;
+    int slowestLoss = -1;
+    for (Bitboard empty = rules.fullMask & ~(x | o); empty != 0; empty &= empty - 1) {
+        const Bitboard bit = empty & (~empty + 1);
+        const PositionValue child = unpackValue(values[xToMove
+            ? rankWithOffsets(offsets, x | bit, o)
+            : rankWithOffsets(offsets, x, o | bit)]);
+        // The child's value is from the OPPONENT's point of view
+        if (child.outcome == Outcome::Loss) fastestWin = std::min(fastestWin, child.plies + 1);
+        if (child.outcome == Outcome::Draw) canDraw = true;
+        if (child.outcome == Outcome::Win) slowestLoss = std::max(slowestLoss, child.plies + 1);
+    }
+    return fastestWin < maxCells ? PositionValue{Outcome::Win, fastestWin}
+         : (canDraw || slowestLoss < 0) ? PositionValue{Outcome::Draw, 0}
+         : PositionValue{Outcome::Loss, slowestLoss};
+}
+
+Tablebase solveTablebase(const MnkRules& rules, int threads) {
+    const int cells = rules.cells;
+    const std::vector<std::uint64_t> offsets = layerOffsets(cells);
+    const std::uint64_t total = offsets[cells + 1];
+    std::shared_ptr<std::uint8_t> values(new std::uint8_t[total], std::default_delete<std::uint8_t[]>());
+
+    // Full board first, then one layer back at a time
+    for (int n = cells; n >= 0; --n) {
+        const std::uint64_t begin = offsets[n];
+        const std::uint64_t end = offsets[n + 1];
+        const std::uint64_t chunk = (end - begin + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                const std::uint64_t from = begin + chunk * t;
+                const std::uint64_t to = std::min(end, from + chunk);
+                for (std::uint64_t r = from; r < to; ++r) {
+                    const std::pair<Bitboard, Bitboard> position = positionUnrank(cells, r);
+                    values.get()[r] = packValue(
+                        solvePosition(rules, offsets, values.get(), position.first, position.second));
+                }
+            });
+        }
+        std::for_each(workers.begin(), workers.end(), [](std::thread& w) { w.join(); });
+    }
+    return Tablebase{rules, total, values};
+}
+
+// ============================================================================
+// Files
+//
+// Layout: a 32-byte header, then one value byte per ranked position.
+// ============================================================================
+
+struct TablebaseHeader {
+    char magic[8];
+    std::int32_t rows;
+    std::int32_t cols;
+    std::int32_t k;
+    std::int32_t reserved;
+    std::uint64_t positions;
+};
+
+constexpr char tablebaseMagic[8] = {'T', 'T', 'T', 'B', 'A', 'S', 'E', '1'};
+
+bool writeTablebase(const Tablebase& tablebase, const std::string& path) {
+    TablebaseHeader header{{}, tablebase.rules.rows, tablebase.rules.cols, tablebase.rules.k, 0,
+                           tablebase.positions};
+    std::memcpy(header.magic, tablebaseMagic, sizeof header.magic);
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof header);
+    out.write(reinterpret_cast<const char*>(tablebase.values.get()),
+              static_cast<std::streamsize>(tablebase.positions));
+    return static_cast<bool>(out);
+}
+
+// Helper: check a header read from disk against the file size
+bool validHeader(const TablebaseHeader& header, std::uint64_t fileSize) {
+    return std::memcmp(header.magic, tablebaseMagic, sizeof header.magic) == 0 &&
+           header.rows > 0 && header.cols > 0 && header.rows * header.cols <= maxTablebaseCells &&
+           header.positions == rankedPositionCount(header.rows * header.cols) &&
+           fileSize == sizeof(TablebaseHeader) + header.positions;
+}
+
+std::optional<Tablebase> openTablebase(const std::string& path) {
+#ifdef __linux__
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct stat info {};
+    const bool statOk = fstat(fd, &info) == 0 && static_cast<std::uint64_t>(info.st_size) >= sizeof(TablebaseHeader);
+    void* mapping = statOk ? mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);  // the mapping stays valid after the descriptor is closed
+    if (mapping == MAP_FAILED) return std::nullopt;
+
+    const std::size_t size = static_cast<std::size_t>(info.st_size);
+    const TablebaseHeader* header = static_cast<const TablebaseHeader*>(mapping);
+    if (!validHeader(*header, size)) {
+        munmap(mapping, size);
+        return std::nullopt;
+    }
+    // Probes jump around the file; don't waste I/O on read-ahead
+    madvise(mapping, size, MADV_RANDOM);
+    const std::uint8_t* base = static_cast<const std::uint8_t*>(mapping);
+    return Tablebase{makeRules(header->rows, header->cols, header->k), header->positions,
+        std::shared_ptr<const std::uint8_t>(base + sizeof(TablebaseHeader),
+            [mapping, size](const std::uint8_t*) { munmap(mapping, size); })};
+#else
+    // No mmap: read the whole file instead
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    const std::uint64_t size = in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+    TablebaseHeader header{};
+    in.seekg(0);
+    if (!in || size < sizeof header || !in.read(reinterpret_cast<char*>(&header), sizeof header) ||
+        !validHeader(header, size)) {
+        return std::nullopt;
+    }
+    std::shared_ptr<std::uint8_t> values(new std::uint8_t[header.positions], std::default_delete<std::uint8_t[]>());
+    in.read(reinterpret_cast<char*>(values.get()), static_cast<std::streamsize>(header.positions));
+    return in ? std::optional{Tablebase{makeRules(header.rows, header.cols, header.k), header.positions, values}}
+              : std::nullopt;
+#endif
+}
+
+PositionValue tablebaseProbe(const Tablebase& tablebase, const MnkState& state) {
+    return unpackValue(tablebase.values.get()[positionRank(tablebase.rules.cells, state.x, state.o)]);
+}
+
+// Helper: how good a child is for the player who moved into it
+int childPreference(PositionValue child) {
+    return child.outcome == Outcome::Loss ? 1000 - child.plies
+         : child.outcome == Outcome::Draw ? 0
+         : -1000 + child.plies;
+}
+
+MnkStrategy tablebaseStrategy(Tablebase tablebase) {
+    return [tablebase](const MnkRules& rules, const MnkState& state) {
+        const std::vector<int> moves = mnkValidMoves(rules, state);
+        return moves.empty() ? -1 : *std::max_element(moves.begin(), moves.end(), [&](int a, int b) {
+            return childPreference(tablebaseProbe(tablebase, mnkPlay(rules, state, a)))
+                 < childPreference(tablebaseProbe(tablebase, mnkPlay(rules, state, b)));
+        });
+    };
+}
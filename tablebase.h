@@ -0,0 +1,107 @@
+#ifndef TICTACTOE_TABLEBASE_H
+#define TICTACTOE_TABLEBASE_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+// ============================================================================
+// TABLEBASES
+//
+// A tablebase stores the game-theoretic value of EVERY position of a board:
+// win, loss or draw with perfect play, and how many plies until the game
+// ends. Once built, "solving" a position is a single array lookup.
+//
+// 4x4 has 3^16 = 43 million ways to fill the cells, but only about 10 million
+// of them have a legal number of pieces. Building the table takes a few
+// seconds with several threads - too slow to do every time a program starts,
+// but trivial to do once and save to a file.
+// ============================================================================
+
+// ============================================================================
+// COMBINATORIAL RANKING
+//
+// To store one byte per position we need a PERFECT HASH: a function that
+// gives every legal position a different index in 0 .. count-1.
+//
+// Positions are grouped by piece count n (X has ceil(n/2) pieces, O has
+// floor(n/2)). Within group n a position is two choices:
+//   1. which n of the cells are occupied       - C(cells, n) possibilities
+//   2. which of those n cells hold an O         - C(n, n/2) possibilities
+// Each choice of a subset is numbered with the "combinatorial number system":
+// the subset {c1 < c2 < ... < cm} gets rank C(c1,1) + C(c2,2) + ... + C(cm,m),
+// which numbers all m-subsets 0, 1, 2, ... without gaps.
+//
+//   rank = layerOffset(n) + rank(occupied) * C(n, n/2) + rank(O within occupied)
+// ============================================================================
+
+// Largest board the tablebase code handles (5x4 = 20 cells is ~741MB)
+constexpr int maxTablebaseCells = 20;
+
+// Number of ranked positions (with legal piece counts) on a board of 'cells'
+std::uint64_t rankedPositionCount(int cells);
+
+// Index of the first position with n pieces
+std::uint64_t layerOffset(int cells, int pieces);
+
+// Rank / unrank a position. Requires a legal piece count (X = O or O + 1).
+std::uint64_t positionRank(int cells, Bitboard x, Bitboard o);
+std::pair<Bitboard, Bitboard> positionUnrank(int cells, std::uint64_t rank);
+
+// ============================================================================
+// Values
+// ============================================================================
+
+// Result for the side to move. Illegal marks ranked positions that cannot
+// occur in a game (the side to move already has a line).
+enum class Outcome : std::uint8_t { Illegal, Loss, Draw, Win };
+
+struct PositionValue {
+    Outcome outcome;
+    int plies;   // moves until the game ends with perfect play (0 for draws)
+};
+
+// Values are stored one byte each: outcome in the top 2 bits, plies below
+std::uint8_t packValue(PositionValue value);
+PositionValue unpackValue(std::uint8_t byte);
+
+// A solved board. The values live either in memory (just solved) or in a
+// memory-mapped file; the shared_ptr's deleter knows which. Copying a
+// Tablebase is cheap and shares the values.
+struct Tablebase {
+    MnkRules rules;
+    std::uint64_t positions;
+    std::shared_ptr<const std::uint8_t> values;
+};
+
+// ============================================================================
+// RETROGRADE ANALYSIS
+//
+// Solve the game BACKWARDS. Positions with all cells filled have no moves;
+// their values are known immediately. A position with n pieces only has
+// children with n + 1 pieces, so once layer n + 1 is solved, every position
+// in layer n is decided from its children:
+//   - some move leaves the opponent lost     -> Win  (fastest such move)
+//   - otherwise some move leads to a draw    -> Draw
+//   - otherwise every move loses             -> Loss (slowest such move)
+//
+// Positions within one layer don't depend on each other, so each layer is
+// split into chunks that are solved by separate threads.
+// ============================================================================
+Tablebase solveTablebase(const MnkRules& rules, int threads);
+
+// Save to / map from a file. The file is a small header followed by the raw
+// values, so opening it is one mmap() call: the operating system reads pages
+// in lazily as probes touch them, and shares them between processes.
+bool writeTablebase(const Tablebase& tablebase, const std::string& path);
+std::optional<Tablebase> openTablebase(const std::string& path);
+
+// Value of a position for its side to move
+PositionValue tablebaseProbe(const Tablebase& tablebase, const MnkState& state);
+
+// Perfect-play strategy: win as fast as possible, lose as slowly as possible
+MnkStrategy tablebaseStrategy(Tablebase tablebase);
+
+#endif // TICTACTOE_TABLEBASE_H
@@ -0,0 +1,107 @@
+#include "td.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <thread>
+
+ValueTable makeValueTable(const MnkRules& rules) {
+    ValueTable table{rules, std::vector<std::atomic<float>>(rankedPositionCount(rules.cells))};
+    for (std::atomic<float>& value : table.values) value.store(0.5f, std::memory_order_relaxed);
+    return table;
+}
+
+float afterstateValue(const ValueTable& table, const MnkState& state) {
+    if (state.winner != Cell::Empty) return 1.0f;
+    if (state.moves == table.rules.cells) return 0.5f;
+    return table.values[positionRank(table.rules.cells, state.x, state.o)].load(std::memory_order_relaxed);
+}
+
+// Helper: the child with the highest value (-1 if there are no moves)
+int greedyMove(const ValueTable& table, const MnkState& state) {
+    int best = -1;
+    float bestValue = -1.0f;
+    for (Bitboard b = emptyCells(table.rules, state); b != 0; b &= b - 1) {
+        const int cell = __builtin_ctzll(b);
+        const float value = afterstateValue(table, mnkPlay(table.rules, state, cell));
+        if (value > bestValue) {
+            bestValue = value;
+            best = cell;
+        }
+    }
+    return best;
+}
+
+// Helper: a uniformly random empty cell
+int randomMove(const MnkRules& rules, const MnkState& state, std::uint64_t random) {
+    Bitboard empty = emptyCells(rules, state);
+    for (int skip = static_cast<int>(random % static_cast<std::uint64_t>(__builtin_popcountll(empty))); skip > 0; --skip) {
+        empty &= empty - 1;
+    }
+    return __builtin_ctzll(empty);
+}
+
+// Helper: one thread's share of the games
+TdStats trainGames(ValueTable& table, const TdConfig& config, int games, std::uint64_t seed) {
+    const MnkRules& rules = table.rules;
+    TdStats stats;
+    std::uint64_t counter = seed * 0x100000000ull;
+
+    // Both sides are the same learner: choose a move, then back up the
+    // afterstate it leads to
+    const MnkStrategy learner = [&](const MnkRules&, const MnkState& state) {
+        const std::uint64_t random = splitMix64(counter++);
+        const bool explore = static_cast<float>(random >> 40) < config.epsilon * static_cast<float>(1 << 24);
+        const int move = explore ? randomMove(rules, state, splitMix64(counter++)) : greedyMove(table, state);
+
+        const MnkState after = mnkPlay(rules, state, move);
+        if (!mnkIsGameOver(rules, after)) {
+            const int reply = greedyMove(table, after);
+            const float target = 1.0f - afterstateValue(table, mnkPlay(rules, after, reply));
+            // Hogwild: another thread may store in between; one lost nudge
+            std::atomic<float>& value = table.values[positionRank(rules.cells, after.x, after.o)];
+            const float old = value.load(std::memory_order_relaxed);
+            value.store(old + config.alpha * (target - old), std::memory_order_relaxed);
+            ++stats.updates;
+        }
+        return move;
+    };
+
+    for (int g = 0; g < games; ++g) {
+        playMnkGame(rules, learner, learner);
+        ++stats.games;
+    }
+    return stats;
+}
+
+// Helper: thread t's share when 'games' are split over 'threads' threads.
+// Computed in 64 bits: games * threads alone can overflow an int.
+int gameShare(int games, int threads, int t) {
+    const std::int64_t total = games;
+    return static_cast<int>(total * (t + 1) / threads - total * t / threads);
+}
+
+TdStats tdTrain(ValueTable& table, const TdConfig& config) {
+    const int threads = std::max(config.threads, 1);
+    std::vector<TdStats> partials(static_cast<std::size_t>(threads));
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            partials[t] = trainGames(table, config, gameShare(config.games, threads, t),
+                                     config.seed + static_cast<std::uint64_t>(t) * 0x9E3779B9ull);
+        });
+    }
+    partials[0] = trainGames(table, config, gameShare(config.games, threads, 0), config.seed);
+    std::for_each(workers.begin(), workers.end(), [](std::thread& t) { t.join(); });
+
+    TdStats total;
+    for (const TdStats& p : partials) {
+        total.games += p.games;
+        total.updates += p.updates;
+    }
+    return total;
+}
+
+MnkStrategy valueTableStrategy(std::shared_ptr<const ValueTable> table) {
+    return [table](const MnkRules&, const MnkState& state) {
+        return greedyMove(*table, state);
+    };
+}
@@ -0,0 +1,84 @@
+#ifndef TICTACTOE_TD_H
+#define TICTACTOE_TD_H
+
+#include "mnk.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// TEMPORAL-DIFFERENCE LEARNING
+//
+// Instead of searching, LEARN a value for every position by playing against
+// yourself. The value table has one entry per position, indexed by the
+// tablebase's perfect hash (positionRank), so a lookup is a rank computation
+// and one array read - no hashing, no collisions.
+//
+// We learn AFTERSTATE values: V(a) is how good position a is for the player
+// who just moved into it (1 = win, 1/2 = draw, 0 = loss). Playing greedily is
+// then simply "move to the child with the highest V".
+//
+// After each move into a, V(a) is nudged towards what one step of lookahead
+// says it is worth. The opponent will reply with its best child b, and what
+// is good for them is bad for us:
+//
+//   V(a) += alpha * ((1 - max over children b of V(b)) - V(a))
+//
+// Finished games need no learning: a won position is worth exactly 1, a full
+// board exactly 1/2. Those true values enter at the end of the game and
+// flow backwards one move per visit - TD(0). Taking the MAX over replies,
+// rather than the reply actually played, makes it Q-learning: the table
+// learns the value of best play even while we play exploratory moves.
+//
+// EPSILON-GREEDY. Playing only the best-looking move would never discover
+// that a neglected one is better, so with probability epsilon we play a
+// random move instead. Because the update looks at the best reply whatever
+// is actually played, exploring a lot costs nothing in what is learned; it
+// only spends games on lines good play would avoid.
+//
+// HOGWILD. With several threads, every thread plays its own games and writes
+// into the ONE shared table with no locks at all. Two threads updating the
+// same entry at the same moment may lose one of the updates - and that is
+// fine: each update is a small nudge, the next visit makes it again, and
+// conflicts are rare because the threads are scattered over a large table.
+// Entries are std::atomic<float> used only with relaxed loads and stores,
+// which compile to the same plain moves as a float but are not a data race
+// in C++ terms; there is no compare-and-swap loop, so a read-modify-write
+// can be overwritten by another thread's.
+// ============================================================================
+
+// Movable but not copyable (atomics); share a trained one through shared_ptr
+struct ValueTable {
+    MnkRules rules;
+    std::vector<std::atomic<float>> values;   // by positionRank; afterstate value for the mover
+};
+
+struct TdConfig {
+    int games = 20000;           // in total, over all threads
+    float alpha = 0.2f;          // step size
+    float epsilon = 0.5f;        // chance of an exploratory move
+    std::uint64_t seed = 1;
+    int threads = 1;             // Hogwild threads sharing the table
+};
+
+struct TdStats {
+    std::uint64_t games = 0;
+    std::uint64_t updates = 0;
+};
+
+// A table with every value at 1/2. The board must fit the tablebase
+// ranking (at most maxTablebaseCells cells).
+ValueTable makeValueTable(const MnkRules& rules);
+
+// Value of afterstate 'state' for the player who moved into it
+float afterstateValue(const ValueTable& table, const MnkState& state);
+
+// Play config.games self-play games through playMnkGame, learning as we go,
+// split over config.threads threads
+TdStats tdTrain(ValueTable& table, const TdConfig& config);
+
+// Greedy strategy: the move to the child with the highest value
+MnkStrategy valueTableStrategy(std::shared_ptr<const ValueTable> table);
+
+#endif // TICTACTOE_TD_H
@@ -0,0 +1,351 @@
+#include "mnk.h"
+#include "tablebase.h"
+#include "external.h"
+#include "perft.h"
+#include "book.h"
+#include "zero.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// COMMAND-LINE TOOLS
+//
+// Long-running jobs that produce files or reports, as opposed to the demo
+// (main.cpp) and the benchmarks (bench.cpp).
+//
+//   ./tictactoe_tools solve ROWS COLS K FILE [THREADS]
+//       retrograde-solve a board (up to 20 cells) and write a tablebase
+//   ./tictactoe_tools probe FILE [CELL ...]
+//       map a tablebase, play the given moves and show every move's value
+//   ./tictactoe_tools external ROWS COLS K WORKDIR [MEMORY_MB]
+//       solve a board of up to 28 cells through files in WORKDIR, using at
+//       most MEMORY_MB (default 2048) of sort buffers
+//   ./tictactoe_tools perft ROWS COLS K DEPTH [THREADS [CELL ...]]
+//       count every move sequence DEPTH plies deep (after playing the given
+//       cells), with wins and draws per ply
+//   ./tictactoe_tools book ROWS COLS K PLIES DEPTH FILE [MARGIN]
+//       search every opening position with fewer than PLIES pieces to DEPTH
+//       and write the best moves (and any within MARGIN) to an opening book
+//   ./tictactoe_tools zero ROWS COLS K GENERATIONS FILE [WORKERS]
+//       train a policy/value network by self-play for GENERATIONS rounds,
+//       with WORKERS (default 8) self-play threads, and write it to FILE
+// ============================================================================
+
+// Helper: name of an outcome for display
+std::string outcomeName(PositionValue value) {
+    return value.outcome == Outcome::Win ? "win in " + std::to_string(value.plies)
+         : value.outcome == Outcome::Loss ? "loss in " + std::to_string(value.plies)
+         : value.outcome == Outcome::Draw ? "draw"
+         : "illegal";
+}
+
+// Helper: default thread count for parallel tools
+int defaultThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Helper: a whole-number argument, or nullopt if it is not one
+std::optional<int> parseInt(const std::string& text) {
+    try {
+        std::size_t used = 0;
+        const int value = std::stoi(text, &used);
+        return used == text.size() ? std::optional{value} : std::nullopt;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+// Helper: the rules named by the ROWS COLS K arguments at args[0..2]. The
+// sizes are checked BEFORE makeRules sees them (a board of more than 64
+// cells would shift past the bitboards); 'command' prefixes the message
+// printed when they are rejected.
+std::optional<MnkRules> parseRules(const char* command, const std::vector<std::string>& args, int maxBoardCells) {
+    const std::optional<int> rows = parseInt(args[0]);
+    const std::optional<int> cols = parseInt(args[1]);
+    const std::optional<int> k = parseInt(args[2]);
+    if (!rows || !cols || *rows < 1 || *cols < 1 || *rows > maxCells || *cols > maxCells) {
+        std::cerr << command << ": ROWS and COLS must be positive numbers\n";
+        return std::nullopt;
+    }
+    if (*rows * *cols > maxBoardCells) {
+        std::cerr << command << ": boards are limited to " << maxBoardCells << " cells\n";
+        return std::nullopt;
+    }
+    if (!k || *k < 1 || *k > std::max(*rows, *cols)) {
+        std::cerr << command << ": K must be between 1 and " << std::max(*rows, *cols) << "\n";
+        return std::nullopt;
+    }
+    return makeRules(*rows, *cols, *k);
+}
+
+// Helper: an optional count argument (threads, workers) that must be at
+// least 1; 'fallback' if it is absent, nullopt (after a message) if invalid
+std::optional<int> parseCount(const char* command, const char* name, const std::vector<std::string>& args,
+                              std::size_t index, int fallback) {
+    if (args.size() <= index) return fallback;
+    const std::optional<int> count = parseInt(args[index]);
+    if (!count || *count < 1) {
+        std::cerr << command << ": " << name << " must be at least 1\n";
+        return std::nullopt;
+    }
+    return count;
+}
+
+int solveCommand(const std::vector<std::string>& args) {
+    if (args.size() < 4) {
+        std::cerr << "usage: solve ROWS COLS K FILE [THREADS]\n";
+        return 1;
+    }
+    const std::optional<MnkRules> parsed = parseRules("solve", args, maxTablebaseCells);
+    const std::optional<int> threadCount = parseCount("solve", "THREADS", args, 4, defaultThreads());
+    if (!parsed || !threadCount) return 1;
+    const MnkRules& rules = *parsed;
+    const int threads = *threadCount;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Tablebase tablebase = solveTablebase(rules, threads);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << rules.rows << "x" << rules.cols << " k=" << rules.k << ": "
+              << tablebase.positions << " positions solved in " << seconds << " s with "
+              << threads << " thread(s)\n";
+    std::cout << "Empty board: " << outcomeName(tablebaseProbe(tablebase, mnkEmpty())) << " for X\n";
+    if (!writeTablebase(tablebase, args[3])) {
+        std::cerr << "solve: could not write " << args[3] << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << args[3] << "\n";
+    return 0;
+}
+
+int probeCommand(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        std::cerr << "usage: probe FILE [CELL ...]\n";
+        return 1;
+    }
+    const std::optional<Tablebase> tablebase = openTablebase(args[0]);
+    if (!tablebase) {
+        std::cerr << "probe: " << args[0] << " is not a valid tablebase\n";
+        return 1;
+    }
+    const MnkRules& rules = tablebase->rules;
+
+    MnkState state = mnkEmpty();
+    for (std::size_t i = 1; i < args.size(); ++i) {
+        const std::optional<int> cell = parseInt(args[i]);
+        const std::optional<MnkState> next = cell ? mnkMakeMove(rules, state, *cell) : std::nullopt;
+        if (!next) {
+            std::cerr << "probe: illegal move " << args[i] << "\n";
+            return 1;
+        }
+        state = *next;
+    }
+
+    std::cout << stateToString(rules, state) << "\n"
+              << cellToChar(state.toMove) << " to move: " << outcomeName(tablebaseProbe(*tablebase, state)) << "\n";
+    for (int cell : mnkValidMoves(rules, state)) {
+        // The child's value is for the opponent; show it from our side
+        const PositionValue child = tablebaseProbe(*tablebase, mnkPlay(rules, state, cell));
+        const PositionValue ours{child.outcome == Outcome::Win ? Outcome::Loss
+                                 : child.outcome == Outcome::Loss ? Outcome::Win
+                                 : child.outcome, child.plies + (child.outcome == Outcome::Draw ? 0 : 1)};
+        std::cout << "  cell " << cell << ": " << outcomeName(ours) << "\n";
+    }
+    return 0;
+}
+
+int externalCommand(const std::vector<std::string>& args) {
+    if (args.size() < 4) {
+        std::cerr << "usage: external ROWS COLS K WORKDIR [MEMORY_MB]\n";
+        return 1;
+    }
+    const std::optional<MnkRules> parsed = parseRules("external", args, maxExternalCells);
+    if (!parsed) return 1;
+    const MnkRules& rules = *parsed;
+    ExternalSolverConfig config;
+    config.workDir = args[3];
+    // MEMORY_MB is shifted into bytes, so keep it where that cannot overflow
+    const std::optional<int> memoryMegabytes = parseCount("external", "MEMORY_MB", args, 4, 2048);
+    if (!memoryMegabytes) return 1;
+    if (static_cast<std::uint64_t>(*memoryMegabytes) > (std::numeric_limits<std::size_t>::max() >> 20)) {
+        std::cerr << "external: MEMORY_MB is too large\n";
+        return 1;
+    }
+    config.memoryBytes = static_cast<std::size_t>(*memoryMegabytes) << 20;
+
+    const auto start = std::chrono::steady_clock::now();
+    const ExternalSolveReport report = solveExternal(rules, config);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!report.error.empty()) {
+        std::cerr << "external: " << report.error << "\n";
+        return 1;
+    }
+
+    std::cout << rules.rows << "x" << rules.cols << " k=" << rules.k << " (canonical positions per layer)\n";
+    std::uint64_t total = 0;
+    for (std::size_t n = 0; n < report.layers.size(); ++n) {
+        std::cout << "  " << n << " pieces: " << report.layers[n].positions << " positions, "
+                  << report.layers[n].runs << " sorted runs\n";
+        total += report.layers[n].positions;
+    }
+    std::cout << total << " positions in " << seconds << " s; "
+              << (report.bytesWritten >> 20) << " MB written, " << (report.bytesRead >> 20) << " MB read\n";
+    std::cout << "Empty board: " << outcomeName(report.root) << " for X\n";
+    return 0;
+}
+
+int perftCommand(const std::vector<std::string>& args) {
+    if (args.size() < 4) {
+        std::cerr << "usage: perft ROWS COLS K DEPTH [THREADS [CELL ...]]\n";
+        return 1;
+    }
+    const std::optional<MnkRules> parsed = parseRules("perft", args, maxCells);
+    const std::optional<int> plies = parseInt(args[3]);
+    const std::optional<int> threadCount = parseCount("perft", "THREADS", args, 4, defaultThreads());
+    if (!parsed || !threadCount) return 1;
+    if (!plies || *plies < 0) {
+        std::cerr << "perft: DEPTH must be 0 or more\n";
+        return 1;
+    }
+    const MnkRules& rules = *parsed;
+    const int threads = *threadCount;
+    MnkState state = mnkEmpty();
+    for (std::size_t i = 5; i < args.size(); ++i) {
+        const std::optional<int> cell = parseInt(args[i]);
+        const std::optional<MnkState> next = cell ? mnkMakeMove(rules, state, *cell) : std::nullopt;
+        if (!next) {
+            std::cerr << "perft: illegal move " << args[i] << "\n";
+            return 1;
+        }
+        state = *next;
+    }
+    const int depth = std::min(*plies, rules.cells - state.moves);
+
+    const auto start = std::chrono::steady_clock::now();
+    const PerftReport report = perft(rules, state, depth, threads);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << stateToString(rules, state) << "\n"
+              << " ply            nodes           X wins           O wins            draws\n";
+    for (std::size_t p = 0; p < report.plies.size(); ++p) {
+        const PerftPly& ply = report.plies[p];
+        std::cout << std::setw(4) << p << std::setw(17) << ply.nodes << std::setw(17) << ply.xWins
+                  << std::setw(17) << ply.oWins << std::setw(17) << ply.draws << "\n";
+    }
+    std::uint64_t xWins = 0, oWins = 0, draws = 0;
+    for (const PerftPly& ply : report.plies) {
+        xWins += ply.xWins;
+        oWins += ply.oWins;
+        draws += ply.draws;
+    }
+    std::cout << report.games << " finished games (" << xWins << " X wins, " << oWins << " O wins, "
+              << draws << " draws)\n"
+              << report.subtrees << " distinct subtrees after symmetry grouping, " << report.visited
+              << " nodes walked in " << seconds << " s with " << threads << " thread(s) ("
+              << std::fixed << std::setprecision(1) << report.visited / seconds / 1e6 << " M nodes/s)\n";
+    return 0;
+}
+
+int bookCommand(const std::vector<std::string>& args) {
+    if (args.size() < 6) {
+        std::cerr << "usage: book ROWS COLS K PLIES DEPTH FILE [MARGIN]\n";
+        return 1;
+    }
+    const std::optional<MnkRules> parsed = parseRules("book", args, maxCells);
+    if (!parsed) return 1;
+    const MnkRules& rules = *parsed;
+    const std::optional<int> plies = parseInt(args[3]);
+    const std::optional<int> depth = parseInt(args[4]);
+    const std::optional<int> margin = args.size() > 6 ? parseInt(args[6]) : std::optional{0};
+    if (!plies || !depth || !margin || *plies < 0 || *depth < 1 || *margin < 0) {
+        std::cerr << "book: PLIES and MARGIN must be 0 or more, DEPTH at least 1\n";
+        return 1;
+    }
+    BookConfig config;
+    config.plies = *plies;
+    config.limits.maxDepth = *depth;
+    config.limits.threads = defaultThreads();
+    config.margin = *margin;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Book book = buildBook(rules, config, [](std::size_t done, std::size_t total) {
+        if (done % 100 == 0 || done == total) std::cerr << "\r  " << done << " / " << total << " positions" << std::flush;
+    });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "\n";
+
+    std::cout << book.size << " book moves in " << seconds << " s\nEmpty board:";
+    for (const BookMove& move : bookProbe(book, mnkEmpty())) {
+        std::cout << " cell " << move.move << " (weight " << move.weight << ", score " << move.score << ")";
+    }
+    std::cout << "\n";
+    if (!writeBook(book, args[5])) {
+        std::cerr << "book: could not write " << args[5] << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << args[5] << "\n";
+    return 0;
+}
+
+int zeroCommand(const std::vector<std::string>& args) {
+    if (args.size() < 5) {
+        std::cerr << "usage: zero ROWS COLS K GENERATIONS FILE [WORKERS]\n";
+        return 1;
+    }
+    ZeroConfig config;
+    const std::optional<MnkRules> parsed = parseRules("zero", args, maxCells);
+    const std::optional<int> generations = parseCount("zero", "GENERATIONS", args, 3, config.generations);
+    const std::optional<int> workers = parseCount("zero", "WORKERS", args, 5, config.workers);
+    if (!parsed || !generations || !workers) return 1;
+    const MnkRules& rules = *parsed;
+    config.generations = *generations;
+    config.workers = *workers;
+
+    const Mlp mlp = zeroTrain(rules, config, [](const ZeroGeneration& g) {
+        std::cerr << std::fixed << "  generation " << g.generation << ": " << g.xWins << "/" << g.draws << "/"
+                  << g.oWins << " X/draw/O, loss " << std::setprecision(3) << g.loss.policy << " + " << g.loss.value
+                  << ", " << std::setprecision(1) << g.selfPlaySeconds + g.trainingSeconds << " s\n";
+    });
+    if (!writeMlp(mlp, args[4])) {
+        std::cerr << "zero: could not write " << args[4] << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << args[4] << "\n";
+    return 0;
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+struct Tool {
+    const char* name;
+    int (*run)(const std::vector<std::string>& args);
+};
+
+constexpr Tool tools[] = {
+    {"solve", solveCommand},
+    {"probe", probeCommand},
+    {"external", externalCommand},
+    {"perft", perftCommand},
+    {"book", bookCommand},
+    {"zero", zeroCommand},
+};
+
+int main(int argc, char** argv) {
+    const std::vector<std::string> args(argv + std::min(argc, 2), argv + argc);
+    for (const Tool& tool : tools) {
+        if (argc > 1 && std::strcmp(argv[1], tool.name) == 0) return tool.run(args);
+    }
+    std::cerr << "usage: " << argv[0] << " COMMAND [ARGS...]\ncommands:";
+    for (const Tool& tool : tools) std::cerr << " " << tool.name;
+    std::cerr << "\n";
+    return 1;
+}
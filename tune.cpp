@@ -0,0 +1,197 @@
+#include "tune.h"
+#include "workpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+HeuristicWeights defaultHeuristicWeights(const MnkRules& rules) {
+    HeuristicWeights weights(static_cast<std::size_t>(2 * rules.k));
+    float value = 1.0f;
+    for (int c = 0; c < rules.k; ++c, value *= 4.0f) {
+        weights[static_cast<std::size_t>(c)] = value;
+        weights[static_cast<std::size_t>(rules.k + c)] = value * 0.75f;
+    }
+    // A line one piece short: take the win first, block second
+    weights[static_cast<std::size_t>(rules.k - 1)] = 1e6f;
+    weights[static_cast<std::size_t>(2 * rules.k - 1)] = 1e5f;
+    return weights;
+}
+
+int heuristicMove(const MnkRules& rules, const HeuristicWeights& weights, const MnkState& state) {
+    if (mnkIsGameOver(rules, state)) return -1;
+    const Bitboard own = ownPieces(state);
+    const Bitboard opp = opponentPieces(state);
+    int best = -1;
+    float bestScore = 0.0f;
+    for (Bitboard b = emptyCells(rules, state); b != 0; b &= b - 1) {
+        const int cell = __builtin_ctzll(b);
+        float score = 0.0f;
+        for (int line : rules.linesThrough[static_cast<std::size_t>(cell)]) {
+            const Bitboard mask = rules.lines[static_cast<std::size_t>(line)];
+            const int ours = __builtin_popcountll(mask & own);
+            const int theirs = __builtin_popcountll(mask & opp);
+            if (theirs == 0) score += weights[static_cast<std::size_t>(ours)];
+            if (ours == 0) score += weights[static_cast<std::size_t>(rules.k + theirs)];
+        }
+        if (best < 0 || score > bestScore) {
+            best = cell;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+MnkStrategy heuristicStrategy(HeuristicWeights weights) {
+    return [weights = std::move(weights)](const MnkRules& rules, const MnkState& state) {
+        return heuristicMove(rules, weights, state);
+    };
+}
+
+// ============================================================================
+// Mini-Tournaments
+// ============================================================================
+
+// Helper: 'plies' random moves from the empty board, drawn from 'seed'
+MnkState randomOpening(const MnkRules& rules, std::uint64_t seed, int plies) {
+    MnkState state = mnkEmpty();
+    for (int p = 0; p < plies && !mnkIsGameOver(rules, state); ++p) {
+        const Bitboard empty = emptyCells(rules, state);
+        Bitboard b = empty;
+        for (auto skip = splitMix64(seed + static_cast<std::uint64_t>(p)) % static_cast<std::uint64_t>(__builtin_popcountll(empty));
+             skip > 0; --skip) {
+            b &= b - 1;
+        }
+        state = mnkPlay(rules, state, __builtin_ctzll(b));
+    }
+    return state;
+}
+
+// Helper: finish a game from 'state'; like playMnkGame, an invalid move
+// ends it as a draw
+Cell playFrom(const MnkRules& rules, MnkState state, const MnkStrategy& xStrategy, const MnkStrategy& oStrategy) {
+    while (!mnkIsGameOver(rules, state)) {
+        const int cell = (state.toMove == Cell::X ? xStrategy : oStrategy)(rules, state);
+        const std::optional<MnkState> next = mnkMakeMove(rules, state, cell);
+        if (!next) return Cell::Empty;
+        state = *next;
+    }
+    return state.winner;
+}
+
+// Helper: points for 'player' from one opening played with both colours, 0 .. 2
+float pairPoints(const MnkRules& rules, const MnkStrategy& player, const MnkStrategy& reference,
+                 std::uint64_t openingSeed, int openingPlies) {
+    const MnkState opening = randomOpening(rules, openingSeed, openingPlies);
+    const auto points = [](Cell winner, Cell side) { return winner == side ? 1.0f : winner == Cell::Empty ? 0.5f : 0.0f; };
+    return points(playFrom(rules, opening, player, reference), Cell::X) +
+           points(playFrom(rules, opening, reference, player), Cell::O);
+}
+
+// Helper: the seed of opening j in a tournament seeded with 'seed'. It does
+// not depend on the candidate: that is the common random numbers.
+std::uint64_t openingSeed(std::uint64_t seed, int j) {
+    return splitMix64(seed + static_cast<std::uint64_t>(j));
+}
+
+double heuristicFitness(const MnkRules& rules, const HeuristicWeights& weights,
+                        const std::vector<MnkStrategy>& references, int openings, int openingPlies,
+                        std::uint64_t seed) {
+    const MnkStrategy player = heuristicStrategy(weights);
+    double points = 0.0;
+    for (const MnkStrategy& reference : references) {
+        for (int j = 0; j < openings; ++j) points += pairPoints(rules, player, reference, openingSeed(seed, j), openingPlies);
+    }
+    return points / (2.0 * static_cast<double>(references.size()) * openings);
+}
+
+// ============================================================================
+// Evolution
+// ============================================================================
+
+// Helper: the best of 'size' candidates drawn at random
+std::size_t tournamentPick(const std::vector<double>& fitness, int size, std::mt19937_64& rng) {
+    std::size_t best = rng() % fitness.size();
+    for (int i = 1; i < size; ++i) {
+        const std::size_t other = rng() % fitness.size();
+        if (fitness[other] > fitness[best]) best = other;
+    }
+    return best;
+}
+
+HeuristicWeights tuneHeuristic(const MnkRules& rules, const std::vector<MnkStrategy>& references,
+                               const TuneConfig& config,
+                               const std::function<void(const TuneGeneration&)>& progress) {
+    std::mt19937_64 rng(splitMix64(config.seed));
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> gaussian(0.0f, 1.0f);
+    const std::size_t size = static_cast<std::size_t>(std::max(config.population, 2));
+    const std::size_t games = references.size() * static_cast<std::size_t>(config.openings);
+
+    std::vector<HeuristicWeights> population(size, HeuristicWeights(static_cast<std::size_t>(2 * rules.k)));
+    for (HeuristicWeights& weights : population) {
+        for (float& w : weights) w = uniform(rng);
+    }
+
+    const std::unique_ptr<WorkPool> pool = startWorkPool(std::max(config.threads, 1));
+    std::vector<float> points(size * games);   // [candidate][reference][opening]
+    std::vector<double> fitness(size);
+    HeuristicWeights best;
+    for (int generation = 1; generation <= config.generations; ++generation) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::uint64_t seed = splitMix64(config.seed + static_cast<std::uint64_t>(generation) * 1000003u);
+
+        // Fitness: one task per (candidate, reference, opening), each with its own slot
+        TaskGroup group;
+        for (std::size_t i = 0; i < size; ++i) {
+            for (std::size_t g = 0; g < games; ++g) {
+                workSpawn(*pool, 0, group, [&, i, g](int) {
+                    const MnkStrategy& reference = references[g / static_cast<std::size_t>(config.openings)];
+                    const int j = static_cast<int>(g % static_cast<std::size_t>(config.openings));
+                    points[i * games + g] = pairPoints(rules, heuristicStrategy(population[i]), reference,
+                                                       openingSeed(seed, j), config.openingPlies);
+                });
+            }
+        }
+        workWait(*pool, 0, group);
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto first = points.begin() + static_cast<std::ptrdiff_t>(i * games);
+            fitness[i] = std::accumulate(first, first + static_cast<std::ptrdiff_t>(games), 0.0) /
+                         (2.0 * static_cast<double>(std::max<std::size_t>(games, 1)));
+        }
+
+        std::vector<std::size_t> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return fitness[a] > fitness[b]; });
+        best = population[order[0]];
+
+        TuneGeneration report;
+        report.generation = generation;
+        report.bestFitness = fitness[order[0]];
+        report.meanFitness = std::accumulate(fitness.begin(), fitness.end(), 0.0) / static_cast<double>(size);
+        report.best = best;
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (progress) progress(report);
+        if (generation == config.generations) break;
+
+        // Next generation: elites, then children of tournament winners
+        std::vector<HeuristicWeights> next;
+        for (std::size_t e = 0; e < std::min<std::size_t>(static_cast<std::size_t>(config.elites), size); ++e) {
+            next.push_back(population[order[e]]);
+        }
+        while (next.size() < size) {
+            const HeuristicWeights& a = population[tournamentPick(fitness, config.tournamentSize, rng)];
+            const HeuristicWeights& b = population[tournamentPick(fitness, config.tournamentSize, rng)];
+            HeuristicWeights child(a.size());
+            for (std::size_t w = 0; w < child.size(); ++w) {
+                child[w] = (rng() & 1) ? a[w] : b[w];
+                child[w] += config.mutation * gaussian(rng) * std::max(std::fabs(child[w]), 0.01f);
+            }
+            next.push_back(std::move(child));
+        }
+        population = std::move(next);
+    }
+    stopWorkPool(*pool);
+    return best;
+}
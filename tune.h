@@ -0,0 +1,101 @@
+#ifndef TICTACTOE_TUNE_H
+#define TICTACTOE_TUNE_H
+
+#include "mnk.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// ============================================================================
+// A HEURISTIC PLAYER WITH KNOBS
+//
+// A one-move-deep player for k-in-a-row games: score every empty cell by the
+// lines through it, play the best. A line's contribution depends on what is
+// already in it:
+//
+//   no opponent pieces, c of ours    weights[c]       building our own line
+//   no pieces of ours, c of theirs   weights[k + c]   getting in their way
+//   pieces of both                   nothing          dead line
+//
+// An empty line counts on both sides. With k weights per side that is 2k
+// numbers, and they decide everything: whether a win is taken before a
+// block (weights[k - 1] > weights[2k - 1]), how much an open line with one
+// piece is worth against one with two, ... Ties go to the lowest cell, so
+// the player is deterministic.
+// ============================================================================
+
+// 2k numbers, laid out as above
+using HeuristicWeights = std::vector<float>;
+
+// Hand-picked weights: 4^c to build, a little less to block, a completed
+// line above everything
+HeuristicWeights defaultHeuristicWeights(const MnkRules& rules);
+
+// The cell the heuristic plays (-1 if the game is over)
+int heuristicMove(const MnkRules& rules, const HeuristicWeights& weights, const MnkState& state);
+
+MnkStrategy heuristicStrategy(HeuristicWeights weights);
+
+// ============================================================================
+// GENETIC TUNING
+//
+// Picking those numbers by hand is slow on bigger boards, so let evolution
+// do it. A POPULATION of weight vectors goes through GENERATIONS of:
+//
+//   1. fitness    every candidate plays a mini-tournament against fixed
+//                 reference strategies: each opening is played twice, once
+//                 as X and once as O; win = 1, draw = 1/2, loss = 0
+//   2. selection  the best few (ELITES) are copied unchanged; every other
+//                 slot gets a child of two parents, each parent the best of
+//                 a few candidates picked at random (tournament selection)
+//   3. variation  the child takes each weight from one parent or the other
+//                 (uniform crossover) and then some gaussian noise
+//
+// COMMON RANDOM NUMBERS. The openings - a few random moves before the
+// players take over - are the only randomness in a game, and every candidate
+// of a generation plays the SAME openings. Two candidates' scores then
+// differ because of their weights, not because one of them happened to
+// draw easier positions, so a small tournament ranks them reliably. The
+// openings change from generation to generation so nobody can overfit them.
+//
+// Fitness is where the time goes, and every game is independent: the games
+// run as tasks on the work-stealing pool (workpool.h), each writing its
+// result into its own slot.
+// ============================================================================
+
+struct TuneConfig {
+    int population = 24;
+    int generations = 20;
+    int elites = 2;                 // best candidates copied unchanged
+    int tournamentSize = 3;         // candidates per parent selection
+    float mutation = 0.3f;          // noise, relative to each weight's size
+    int openings = 16;              // per reference strategy and generation
+    int openingPlies = 4;           // random moves before the players start
+    int threads = 1;
+    std::uint64_t seed = 1;
+};
+
+struct TuneGeneration {
+    int generation = 0;
+    double bestFitness = 0.0;       // share of the points, 0 .. 1
+    double meanFitness = 0.0;
+    HeuristicWeights best;
+    double seconds = 0.0;
+};
+
+// Evolve weights for 'rules' against 'references', starting from random
+// weights. The references are called from several threads at once and
+// should be deterministic, or the common random numbers are lost.
+// 'progress' (if set) is called after every generation; the best candidate
+// of the last generation is returned.
+HeuristicWeights tuneHeuristic(const MnkRules& rules, const std::vector<MnkStrategy>& references,
+                               const TuneConfig& config,
+                               const std::function<void(const TuneGeneration&)>& progress = {});
+
+// Score of 'weights' against 'references' over 'openings' openings per
+// reference, both colours: the fitness measure on its own
+double heuristicFitness(const MnkRules& rules, const HeuristicWeights& weights,
+                        const std::vector<MnkStrategy>& references, int openings, int openingPlies,
+                        std::uint64_t seed);
+
+#endif // TICTACTOE_TUNE_H
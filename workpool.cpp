@@ -0,0 +1,105 @@
+#include "workpool.h"
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+// Helper: take a task from the back of our own deque
+std::optional<WorkTask> popOwn(WorkPool& pool, int worker) {
+    WorkDeque& deque = *pool.deques[worker];
+    const std::lock_guard<std::mutex> guard(deque.lock);
+    if (deque.tasks.empty()) return std::nullopt;
+    WorkTask task = std::move(deque.tasks.back());
+    deque.tasks.pop_back();
+    return task;
+}
+
+// Helper: take a task from the front of another worker's deque. Victims
+// are tried in order starting after ourselves, so thieves spread out.
+std::optional<WorkTask> steal(WorkPool& pool, int worker) {
+    const int workers = static_cast<int>(pool.deques.size());
+    for (int i = 1; i < workers; ++i) {
+        WorkDeque& deque = *pool.deques[(worker + i) % workers];
+        const std::lock_guard<std::mutex> guard(deque.lock);
+        if (!deque.tasks.empty()) {
+            WorkTask task = std::move(deque.tasks.front());
+            deque.tasks.pop_front();
+            pool.steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return std::nullopt;
+}
+
+bool workRunOne(WorkPool& pool, int worker) {
+    if (pool.queued.load(std::memory_order_acquire) == 0) return false;
+    std::optional<WorkTask> task = popOwn(pool, worker);
+    if (!task) task = steal(pool, worker);
+    if (!task) return false;
+    pool.queued.fetch_sub(1, std::memory_order_relaxed);
+    task->run(worker);
+    // Release: everything the task wrote is visible to whoever sees 0
+    task->group->pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// Helper: the loop each pool-owned worker runs
+void workerLoop(WorkPool& pool, int worker) {
+    while (!pool.done.load(std::memory_order_acquire)) {
+        if (!workRunOne(pool, worker)) {
+            // Nothing to do: sleep until a spawn wakes us (the timeout only
+            // guards against a wake-up that raced with going to sleep)
+            std::unique_lock<std::mutex> guard(pool.idleLock);
+            pool.idle.wait_for(guard, std::chrono::milliseconds(1), [&]() {
+                return pool.done.load(std::memory_order_acquire) ||
+                       pool.queued.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+}
+
+std::unique_ptr<WorkPool> startWorkPool(int workers) {
+    auto pool = std::make_unique<WorkPool>();
+    for (int i = 0; i < std::max(1, workers); ++i) pool->deques.push_back(std::make_unique<WorkDeque>());
+    for (int i = 1; i < std::max(1, workers); ++i) {
+        pool->threads.emplace_back([p = pool.get(), i]() { workerLoop(*p, i); });
+    }
+    return pool;
+}
+
+void stopWorkPool(WorkPool& pool) {
+    {
+        const std::lock_guard<std::mutex> guard(pool.idleLock);
+        pool.done.store(true, std::memory_order_release);
+    }
+    pool.idle.notify_all();
+    for (std::thread& t : pool.threads) t.join();
+    pool.threads.clear();
+}
+
+void workSpawn(WorkPool& pool, int worker, TaskGroup& group, std::function<void(int)> run) {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        WorkDeque& deque = *pool.deques[worker];
+        const std::lock_guard<std::mutex> guard(deque.lock);
+        deque.tasks.push_back(WorkTask{&group, std::move(run)});
+    }
+    pool.queued.fetch_add(1, std::memory_order_release);
+    pool.idle.notify_one();
+}
+
+void workWait(WorkPool& pool, int worker, const TaskGroup& group) {
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        if (!workRunOne(pool, worker)) std::this_thread::yield();
+    }
+}
+
+void taskGroupCancel(TaskGroup& group) {
+    group.cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool taskGroupCancelled(const TaskGroup* group) {
+    for (; group != nullptr; group = group->parent) {
+        if (group->cancelled.load(std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,90 @@
+#ifndef TICTACTOE_WORKPOOL_H
+#define TICTACTOE_WORKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// WORK-STEALING THREAD POOL
+//
+// A fixed set of worker threads, each with its own DEQUE (double-ended
+// queue) of tasks:
+//
+//   - a worker pushes new tasks onto the BACK of its own deque and takes
+//     its next task from the back too (newest first, like a stack: the
+//     task it just created is the one whose data is still in cache)
+//   - a worker with nothing to do STEALS from the FRONT of somebody else's
+//     deque (oldest first: in a recursive search the oldest task is the
+//     biggest subtree, so one steal buys a lot of work)
+//
+// Owners and thieves touch opposite ends, so they rarely get in each
+// other's way. Each deque still has its own mutex - simple and correct;
+// lock-free deques exist (Chase-Lev) but are much harder to get right.
+//
+// TASK GROUPS: tasks are spawned into a group, and the spawner waits for the
+// whole group. A group can be CANCELLED, which also cancels every group
+// created beneath it (a group knows its parent). Tasks check for that and
+// return early. While it waits, the spawner doesn't sleep - it runs tasks
+// itself, so a waiting thread is never an idle thread.
+//
+// The thread that creates the pool is worker 0 and only does pool work
+// inside workWait; workers 1..n-1 are threads owned by the pool.
+// ============================================================================
+
+struct TaskGroup {
+    const TaskGroup* parent = nullptr;
+    std::atomic<int> pending{0};          // spawned tasks not finished yet
+    std::atomic<bool> cancelled{false};
+};
+
+struct WorkTask {
+    TaskGroup* group;
+    std::function<void(int worker)> run;   // gets the index of the worker running it
+};
+
+struct WorkDeque {
+    std::mutex lock;
+    std::deque<WorkTask> tasks;
+};
+
+struct WorkPool {
+    std::vector<std::unique_ptr<WorkDeque>> deques;   // one per worker
+    std::vector<std::thread> threads;                 // workers 1..n-1
+    std::atomic<bool> done{false};
+    std::atomic<int> queued{0};                       // tasks in all deques
+    std::atomic<std::uint64_t> steals{0};
+    std::mutex idleLock;                              // idle workers sleep here
+    std::condition_variable idle;
+};
+
+// Start a pool with 'workers' workers (the caller counts as worker 0).
+// The pool must stay where it is while running, hence the unique_ptr.
+std::unique_ptr<WorkPool> startWorkPool(int workers);
+
+// Finish: wake and join every worker. Deques must be empty.
+void stopWorkPool(WorkPool& pool);
+
+// Spawn 'run' into 'group' on worker 'worker's deque
+void workSpawn(WorkPool& pool, int worker, TaskGroup& group, std::function<void(int)> run);
+
+// Run one task: the newest of our own, else the oldest stolen from another
+// worker. Returns false if every deque was empty.
+bool workRunOne(WorkPool& pool, int worker);
+
+// Run tasks until every task in 'group' has finished
+void workWait(WorkPool& pool, int worker, const TaskGroup& group);
+
+// Cancel a group (and, through the parent links, everything under it)
+void taskGroupCancel(TaskGroup& group);
+
+// Is this group, or any group above it, cancelled?
+bool taskGroupCancelled(const TaskGroup* group);
+
+#endif // TICTACTOE_WORKPOOL_H
@@ -0,0 +1,282 @@
+#include "zero.h"
+#include "featurize.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+
+// ============================================================================
+// PUCT Search
+//
+// The same arena layout as mcts.cpp: children are a contiguous block of the
+// node vector. A node's valueSum is for the player who moved into it.
+// ============================================================================
+
+struct PuctNode {
+    std::uint32_t firstChild = 0;
+    std::uint16_t childCount = 0;   // 0 = not expanded (or the game is over)
+    std::int16_t move = -1;
+    std::uint32_t visits = 0;
+    float valueSum = 0.0f;          // -1 .. +1 per visit
+    float prior = 0.0f;             // the policy head's probability for 'move'
+};
+
+using ZeroEvaluator = std::function<MlpOutput(const MnkState&)>;
+
+// Helper: children for every empty cell, priors = softmax of their logits
+void expandPuct(const MnkRules& rules, std::vector<PuctNode>& nodes, std::uint32_t index,
+                const MnkState& state, const MlpOutput& output) {
+    const Bitboard empty = emptyCells(rules, state);
+    float largest = -1e30f;
+    for (Bitboard b = empty; b != 0; b &= b - 1) largest = std::max(largest, output.logits[static_cast<std::size_t>(__builtin_ctzll(b))]);
+    const std::uint32_t first = static_cast<std::uint32_t>(nodes.size());
+    float total = 0.0f;
+    for (Bitboard b = empty; b != 0; b &= b - 1) {
+        PuctNode child;
+        child.move = static_cast<std::int16_t>(__builtin_ctzll(b));
+        child.prior = std::exp(output.logits[static_cast<std::size_t>(child.move)] - largest);
+        total += child.prior;
+        nodes.push_back(child);
+    }
+    for (std::size_t i = first; i < nodes.size(); ++i) nodes[i].prior /= total;
+    nodes[index].firstChild = first;
+    nodes[index].childCount = static_cast<std::uint16_t>(nodes.size() - first);
+}
+
+// Helper: the child with the highest PUCT score. Unvisited children count
+// as Q = 0, an even game, until they are tried.
+std::uint32_t selectPuct(const std::vector<PuctNode>& nodes, std::uint32_t index, double cPuct) {
+    const PuctNode& node = nodes[index];
+    const double explore = cPuct * std::sqrt(static_cast<double>(std::max<std::uint32_t>(node.visits, 1)));
+    std::uint32_t best = node.firstChild;
+    double bestScore = -1e30;
+    for (std::uint32_t i = node.firstChild; i < node.firstChild + node.childCount; ++i) {
+        const PuctNode& child = nodes[i];
+        const double q = child.visits > 0 ? child.valueSum / static_cast<double>(child.visits) : 0.0;
+        const double score = q + explore * child.prior / (1.0 + child.visits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Helper: mix Dirichlet(alpha) noise into the root's priors. A Dirichlet
+// sample is independent Gamma(alpha) draws, normalized.
+void addRootNoise(std::vector<PuctNode>& nodes, double alpha, double fraction, std::mt19937_64& rng) {
+    const PuctNode& root = nodes[0];
+    std::gamma_distribution<double> gamma(alpha, 1.0);
+    std::vector<double> noise(root.childCount);
+    double total = 0.0;
+    for (double& n : noise) total += n = gamma(rng);
+    if (total <= 0.0) return;
+    for (std::uint32_t i = 0; i < root.childCount; ++i) {
+        PuctNode& child = nodes[root.firstChild + i];
+        child.prior = static_cast<float>((1.0 - fraction) * child.prior + fraction * noise[i] / total);
+    }
+}
+
+// Helper: run 'simulations' simulations from 'root' (not finished); the
+// root's children hold the visit counts
+std::vector<PuctNode> puctSearch(const MnkRules& rules, const MnkState& root, int simulations, double cPuct,
+                                 const ZeroEvaluator& evaluate, const ZeroConfig* noise, std::mt19937_64* rng) {
+    std::vector<PuctNode> nodes(1);
+    expandPuct(rules, nodes, 0, root, evaluate(root));
+    if (noise != nullptr) addRootNoise(nodes, noise->dirichletAlpha, noise->noiseFraction, *rng);
+
+    std::vector<std::uint32_t> path;
+    for (int s = 0; s < std::max(simulations, 1); ++s) {
+        path.assign(1, 0);
+        MnkState state = root;
+        while (nodes[path.back()].childCount > 0) {
+            path.push_back(selectPuct(nodes, path.back(), cPuct));
+            state = mnkPlay(rules, state, nodes[path.back()].move);
+        }
+        // The leaf's value for the player who moved into it: the game result,
+        // or the net's opinion for the side to move there, negated
+        float value;
+        if (mnkIsGameOver(rules, state)) {
+            value = state.winner != Cell::Empty ? 1.0f : 0.0f;
+        } else {
+            const MlpOutput output = evaluate(state);
+            expandPuct(rules, nodes, path.back(), state, output);
+            value = -output.value;
+        }
+        for (std::size_t d = path.size(); d-- > 0;) {
+            ++nodes[path[d]].visits;
+            nodes[path[d]].valueSum += value;
+            value = -value;
+        }
+    }
+    return nodes;
+}
+
+// Helper: the most visited root move
+int mostVisited(const std::vector<PuctNode>& nodes) {
+    const auto first = nodes.begin() + nodes[0].firstChild;
+    return std::max_element(first, first + nodes[0].childCount, [](const PuctNode& a, const PuctNode& b) {
+               return a.visits < b.visits;
+           })->move;
+}
+
+// ============================================================================
+// Self-Play
+// ============================================================================
+
+// Helper: one self-play game, appended to shard 'writer' of the store;
+// returns the winner
+Cell selfPlayGame(const MnkRules& rules, const ZeroConfig& config, InferenceServer& server,
+                  ReplayStore& store, int writer, std::mt19937_64& rng) {
+    const ZeroEvaluator evaluate = [&server](const MnkState& state) { return inferenceSubmit(server, state).get(); };
+    const std::size_t cells = static_cast<std::size_t>(rules.cells);
+    std::vector<MnkState> states;
+    std::vector<float> policies;   // [ply][cells]
+    MnkState state = mnkEmpty();
+    while (!mnkIsGameOver(rules, state)) {
+        const std::vector<PuctNode> nodes = puctSearch(rules, state, config.simulations, config.cPuct, evaluate, &config, &rng);
+        const PuctNode& root = nodes[0];
+
+        states.push_back(state);
+        policies.resize(states.size() * cells, 0.0f);
+        float* policy = &policies[(states.size() - 1) * cells];
+        std::vector<double> visits(root.childCount);
+        double total = 0.0;
+        for (std::uint32_t i = 0; i < root.childCount; ++i) total += visits[i] = nodes[root.firstChild + i].visits;
+        for (std::uint32_t i = 0; i < root.childCount; ++i) {
+            policy[nodes[root.firstChild + i].move] = static_cast<float>(visits[i] / total);
+        }
+
+        int move;
+        if (state.moves < config.temperatureMoves) {
+            std::discrete_distribution<std::size_t> pick(visits.begin(), visits.end());
+            move = nodes[root.firstChild + pick(rng)].move;
+        } else {
+            move = mostVisited(nodes);
+        }
+        state = mnkPlay(rules, state, move);
+    }
+
+    // The value targets are only known now
+    for (std::size_t ply = 0; ply < states.size(); ++ply) {
+        const float value = state.winner == Cell::Empty ? 0.0f : state.winner == states[ply].toMove ? 1.0f : -1.0f;
+        replayAppend(store, writer, states[ply], &policies[ply * cells], value);
+    }
+    return state.winner;
+}
+
+// ============================================================================
+// Training
+// ============================================================================
+
+// Helper: give every entry of the batch a random symmetry of the board.
+// Samples have no winner to look for, so the images are not rescanned.
+void augmentBatch(const FeatureTables& tables, TrainingBatch& batch, std::mt19937_64& rng) {
+    const std::size_t cells = static_cast<std::size_t>(tables.rules.cells);
+    float moved[maxCells];
+    for (std::size_t entry = 0; entry < batch.states.size(); ++entry) {
+        const int symmetry = static_cast<int>(rng() % tables.rules.symmetries.size());
+        if (symmetry == 0) continue;
+        batch.states[entry] = featureTransform(tables, batch.states[entry], symmetry);
+        float* policy = &batch.policies[entry * cells];
+        featureTransformCells(tables, policy, symmetry, moved);
+        std::copy(moved, moved + cells, policy);
+    }
+}
+
+// Helper: the generation's gradient steps; returns the average loss
+MlpLoss trainGeneration(Mlp& mlp, const ZeroConfig& config, ReplayStore& store, std::mt19937_64& rng) {
+    MlpLoss average;
+    if (replaySize(store) == 0) return average;
+    const FeatureTables tables = makeFeatureTables(mlp.rules);
+    TrainingBatch batch;
+    std::vector<std::uint64_t> slots;
+    std::vector<float> losses(static_cast<std::size_t>(config.trainingBatch));
+    std::uint64_t sampleRng = rng();
+    for (int step = 0; step < config.trainingSteps; ++step) {
+        replaySample(store, config.trainingBatch, config.sampling, sampleRng, batch, &slots);
+        augmentBatch(tables, batch, rng);
+        const MlpLoss loss = mlpTrainBatch(mlp, batch, config.learningRate, config.weightDecay, losses.data());
+        if (config.sampling == ReplaySampling::Prioritized) {
+            for (std::size_t i = 0; i < slots.size(); ++i) replaySetPriority(store, slots[i], losses[i] + 0.01f);
+        }
+        average.policy += loss.policy / config.trainingSteps;
+        average.value += loss.value / config.trainingSteps;
+    }
+    return average;
+}
+
+// Helper: seconds since 'start'
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Mlp zeroTrain(const MnkRules& rules, const ZeroConfig& config,
+              const std::function<void(const ZeroGeneration&)>& progress) {
+    Mlp mlp = makeMlp(rules, config.hidden, config.seed);
+    const int workerCount = std::max(config.workers, 1);
+    // Each worker has at most one request queued at a time, so a batch bigger
+    // than the worker count never fills and every evaluation would wait out
+    // maxWait
+    BatchConfig batch = config.batch;
+    batch.batchSize = std::clamp(batch.batchSize, 1, workerCount);
+    const std::shared_ptr<InferenceServer> server = startInferenceServer(std::make_shared<const Mlp>(mlp), batch);
+    const std::unique_ptr<ReplayStore> store =
+        makeReplayStore(rules, static_cast<std::size_t>(std::max(config.replayCapacity, 1)), workerCount);
+    std::mt19937_64 trainerRng(splitMix64(config.seed));
+
+    for (int generation = 1; generation <= config.generations; ++generation) {
+        ZeroGeneration report;
+        report.generation = generation;
+        report.games = config.gamesPerGeneration;
+        const InferenceStats before = inferenceStats(*server);
+        const std::uint64_t samplesBefore = replayAppended(*store);
+
+        // Self-play: the workers take games off a shared counter
+        const auto selfPlayStart = std::chrono::steady_clock::now();
+        std::atomic<int> nextGame{0};
+        std::atomic<int> results[3] = {};
+        std::vector<std::thread> workers;
+        for (int w = 0; w < workerCount; ++w) {
+            workers.emplace_back([&, w]() {
+                std::mt19937_64 rng(splitMix64(config.seed + static_cast<std::uint64_t>(generation) * 1000003u +
+                                               static_cast<std::uint64_t>(w)));
+                while (nextGame++ < config.gamesPerGeneration) {
+                    const Cell winner = selfPlayGame(rules, config, *server, *store, w, rng);
+                    ++results[winner == Cell::X ? 0 : winner == Cell::Empty ? 1 : 2];
+                }
+            });
+        }
+        std::for_each(workers.begin(), workers.end(), [](std::thread& t) { t.join(); });
+        report.selfPlaySeconds = secondsSince(selfPlayStart);
+        report.xWins = results[0];
+        report.draws = results[1];
+        report.oWins = results[2];
+
+        const InferenceStats after = inferenceStats(*server);
+        report.inference.requests = after.requests - before.requests;
+        report.inference.batches = after.batches - before.batches;
+        report.inference.fullBatches = after.fullBatches - before.fullBatches;
+        report.samples = static_cast<int>(replayAppended(*store) - samplesBefore);
+        report.replaySize = static_cast<int>(replaySize(*store));
+
+        // Training, then the workers of the next generation use the new net
+        const auto trainingStart = std::chrono::steady_clock::now();
+        report.loss = trainGeneration(mlp, config, *store, trainerRng);
+        report.trainingSeconds = secondsSince(trainingStart);
+        inferenceSetNetwork(*server, std::make_shared<const Mlp>(mlp));
+
+        if (progress) progress(report);
+    }
+    stopInferenceServer(*server);
+    return mlp;
+}
+
+MnkStrategy zeroStrategy(std::shared_ptr<const Mlp> mlp, int simulations, double cPuct) {
+    return [mlp, simulations, cPuct](const MnkRules& rules, const MnkState& state) {
+        const ZeroEvaluator evaluate = [&mlp](const MnkState& s) { return mlpForward(*mlp, s); };
+        return mostVisited(puctSearch(rules, state, simulations, cPuct, evaluate, nullptr, nullptr));
+    };
+}
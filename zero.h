@@ -0,0 +1,104 @@
+#ifndef TICTACTOE_ZERO_H
+#define TICTACTOE_ZERO_H
+
+#include "inference.h"
+#include "replay.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// LEARNING FROM SELF-PLAY, ALPHAZERO STYLE
+//
+// A loop with three parts, all in this one process:
+//
+//   self-play  worker threads play games against themselves, choosing each
+//              move with a SEARCH guided by the current network
+//   replay     every position played goes into a replay store (replay.h)
+//              together with what the search thought of it and how the
+//              game ended
+//   training   the network is fitted to random samples from the store,
+//              then replaces the one the workers use
+//
+// The search is a better player than the bare network, so the network keeps
+// learning to imitate something a little stronger than itself; the next
+// generation's searches are better again, and so on.
+//
+// THE SEARCH is MCTS (mcts.h) with the random playouts replaced by the net.
+// Reaching an unexpanded node, we ask the net about its position once: the
+// value head stands in for the playout result, and the policy head gives
+// each child a PRIOR - how promising the move looks before any search.
+// Selection uses PUCT instead of UCT:
+//
+//   score = Q + cPuct * prior * sqrt(parent visits) / (1 + visits)
+//
+// so moves the net likes are explored first, and the exploration bonus of a
+// move the net dislikes shrinks towards zero. Q is the child's average
+// value, -1 .. +1, for the player choosing at the parent.
+//
+// TRAINING TARGETS. For each position of a game we keep
+//   policy  the search's visit counts at the root, normalized to sum to 1
+//   value   the final result for the side that was to move: +1, 0 or -1
+// and the loss is the one mlpTrainBatch minimizes. Samples get a random
+// board symmetry when they are drawn, so one game teaches all its mirror
+// images.
+//
+// EXPLORATION. At the root of every self-play search the priors are mixed
+// with Dirichlet noise, and for the first few moves the move played is
+// drawn in proportion to the visit counts rather than being the most
+// visited one. Without both, self-play would replay the same game forever.
+//
+// BATCHING. A single search has one position to evaluate at a time. Many
+// workers searching at once send theirs to a shared InferenceServer
+// (inference.h), which evaluates them in batches - the reason to run more
+// workers than cores.
+//
+// Generations are synchronous: the workers finish their games, the trainer
+// takes its steps on one thread, the server gets the new net, repeat.
+// ============================================================================
+
+struct ZeroConfig {
+    int hidden = 64;                 // width of the network's hidden layer
+    int workers = 8;                 // self-play threads
+    int generations = 10;
+    int gamesPerGeneration = 128;
+    int simulations = 64;            // search simulations per move
+    double cPuct = 1.5;
+    double dirichletAlpha = 0.5;     // root noise; smaller = spikier
+    double noiseFraction = 0.25;     // share of the root prior that is noise
+    int temperatureMoves = 4;        // moves drawn from the visit counts
+    int replayCapacity = 50000;      // samples kept; the oldest go first
+    ReplaySampling sampling = ReplaySampling::Uniform;   // Prioritized: by training loss
+    int trainingSteps = 200;         // gradient steps per generation
+    int trainingBatch = 64;          // samples per step
+    float learningRate = 0.05f;
+    float weightDecay = 1e-4f;
+    BatchConfig batch;               // the inference server's settings; batchSize is capped at workers
+    std::uint64_t seed = 1;
+};
+
+// What happened in one generation
+struct ZeroGeneration {
+    int generation = 0;
+    int games = 0;
+    int samples = 0;                 // positions added to the replay store
+    int replaySize = 0;              // samples in the store afterwards
+    int xWins = 0;
+    int draws = 0;
+    int oWins = 0;
+    MlpLoss loss;                    // average over the generation's training steps
+    InferenceStats inference;        // requests and batches during its self-play
+    double selfPlaySeconds = 0.0;
+    double trainingSeconds = 0.0;
+};
+
+// Run the whole loop from a randomly initialized network and return the
+// final one. 'progress' (if set) is called after every generation.
+Mlp zeroTrain(const MnkRules& rules, const ZeroConfig& config,
+              const std::function<void(const ZeroGeneration&)>& progress = {});
+
+// Play the most visited move of a PUCT search with the network (no noise)
+MnkStrategy zeroStrategy(std::shared_ptr<const Mlp> mlp, int simulations, double cPuct = 1.5);
+
+#endif // TICTACTOE_ZERO_H